@@ -0,0 +1,260 @@
+/// @file
+/// @brief Benchmarks of config loading on synthetic large libraries.
+/// @details Generates a user config and a generated config at the requested
+/// scale, then times the config pipeline. Each benchmark prints one line of
+/// JSON to stdout, e.g.
+/// `{"bench":"config_parse","buttons":10000,...,"median_ms":12.3}`.
+
+#include "buttoninfo.hpp"
+#include "config.hpp"
+#include "configs.hpp"
+#include "constants.hpp"
+#include "slotmap.hpp"
+#include "svgdefgraph.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <yaml-cpp/yaml.h>
+
+/// @brief Scale of the synthetic library
+struct Scale {
+    int buttons;
+    int defs;
+    /// @brief Length of each `xlink:href` chain of gradients
+    int chainDepth;
+    /// @brief Number of shapes embedded in each pattern
+    int patternShapes;
+};
+
+/// @brief Levels of panels in the synthetic configs
+constexpr int _panelMaxLevels = 42;
+/// @brief Number of slots buttons can take, i.e. those with
+/// `pSlot <= panelMaxLevels * 6`
+constexpr int _numUsableSlots = (_panelMaxLevels * 6 + 1) * SlotIndex::perPanel;
+
+/// @brief Generate a synthetic config
+/// @param firstSlot Buttons occupy dense slot indices from here on
+/// @param prefix Prefix of def ids, to tell configs apart
+static std::string _genConfig(const Scale &scale, int firstSlot, char prefix) {
+    namespace CC = C::C;
+    namespace GK = C::C::G::K;
+    namespace BK = C::C::B::K;
+    namespace SDK = C::C::SD::K;
+    using YAML::BeginMap, YAML::EndMap, YAML::BeginSeq, YAML::EndSeq,
+        YAML::Key, YAML::Value;
+
+    auto defId = [&](int i) { return prefix + std::to_string(i); };
+
+    YAML::Emitter out;
+    out << BeginMap;
+    out << Key << CC::global << Value << BeginMap;
+    out << Key << GK::panelMaxLevels << Value << _panelMaxLevels;
+    out << EndMap;
+
+    // Defs: chains of gradients, each referring to the previous one, and
+    // patterns with lots of shapes in them, alternately
+    out << Key << CC::svgDefs << Value << BeginSeq;
+    for (int i = 0; i < scale.defs; ++i) {
+        out << BeginMap << Key << SDK::id << Value << defId(i);
+        if (i % 2 == 0 || scale.patternShapes == 0) {
+            out << Key << SDK::type << Value << "linearGradient";
+            out << Key << SDK::attrs << Value << BeginMap;
+            int depth = i / 2 % std::max(scale.chainDepth, 1);
+            if (depth > 0)
+                out << Key << "xlink:href" << Value << "#" + defId(i - 2);
+            out << Key << "x2" << Value << "1" << EndMap;
+            out << Key << SDK::svg << Value
+                << R"(<stop offset="0" stop-color="#f00"/>)"
+                   R"(<stop offset="1" stop-color="#00f"/>)";
+        } else {
+            out << Key << SDK::type << Value << "pattern";
+            out << Key << SDK::attrs << Value << BeginMap;
+            out << Key << "width" << Value << "16";
+            out << Key << "height" << Value << "16" << EndMap;
+            std::string shapes;
+            for (int j = 0; j < scale.patternShapes; ++j)
+                shapes += R"(<rect x=")" + std::to_string(j % 16)
+                          + R"(" y=")" + std::to_string(j / 16 % 16)
+                          + R"(" width="1" height="1" fill="#)"
+                          + std::to_string(100 + j % 900) + R"("/>)";
+            out << Key << SDK::svg << Value << shapes;
+        }
+        out << EndMap;
+    }
+    out << EndSeq;
+
+    // Buttons: mostly standard ones using the defs, some custom ones
+    out << Key << CC::buttons << Value << BeginSeq;
+    for (int i = 0; i < scale.buttons; ++i) {
+        quint32 slot = SlotIndex::slotAt(firstSlot + i);
+        out << BeginMap << Key << BK::slot << Value << YAML::Hex << slot;
+        if (i % 10 == 9) {
+            out << Key << BK::customStyle << Value
+                << R"(<rect width="10" height="10"/>)";
+        } else {
+            if (scale.defs)
+                out << Key << BK::fill << Value
+                    << "url(#" + defId(i % scale.defs) + ")";
+            out << Key << BK::stroke << Value << "#123456";
+            out << Key << BK::strokeWidth << Value << std::to_string(i % 5);
+            if (i % 3 == 0)
+                out << Key << BK::strokeDashArray << Value << "1,2";
+        }
+        out << EndMap;
+    }
+    out << EndSeq;
+    out << EndMap;
+    return out.c_str();
+}
+
+static bool _writeFile(const QString &path, const std::string &content) {
+    QFile file(path);
+    return file.open(QFile::WriteOnly)
+           && file.write(content.data(), content.size())
+                  == qint64(content.size());
+}
+
+/// @brief Run a benchmark and print its results
+static void _bench(
+    const QString &name, const Scale &scale, int iterations,
+    const std::function<void()> &func) {
+    // Warm up
+    func();
+
+    QVector<double> times;
+    for (int i = 0; i < iterations; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        func();
+        times.append(timer.nsecsElapsed() / 1e6);
+    }
+    std::sort(times.begin(), times.end());
+
+    QJsonObject result{
+        {"bench", name},
+        {"buttons", scale.buttons},
+        {"defs", scale.defs},
+        {"chain_depth", scale.chainDepth},
+        {"pattern_shapes", scale.patternShapes},
+        {"iterations", iterations},
+        {"min_ms", times.first()},
+        {"median_ms", times[times.size() / 2]},
+        {"mean_ms",
+         std::accumulate(times.begin(), times.end(), 0.) / times.size()},
+        {"max_ms", times.last()},
+    };
+    QTextStream(stdout)
+        << QJsonDocument(result).toJson(QJsonDocument::Compact) << '\n';
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark config loading.");
+    parser.addHelpOption();
+    QCommandLineOption buttonsOpt(
+        "buttons", "Number of buttons.", "n", "10000");
+    QCommandLineOption defsOpt("defs", "Number of svg defs.", "n", "5000");
+    QCommandLineOption chainOpt(
+        "chain-depth", "Length of gradient href chains.", "n", "16");
+    QCommandLineOption shapesOpt(
+        "pattern-shapes", "Shapes embedded in each pattern.", "n", "256");
+    QCommandLineOption iterOpt(
+        "iterations", "Iterations of each benchmark.", "n", "10");
+    parser.addOptions({buttonsOpt, defsOpt, chainOpt, shapesOpt, iterOpt});
+    parser.process(app);
+
+    Scale scale{
+        parser.value(buttonsOpt).toInt(), parser.value(defsOpt).toInt(),
+        parser.value(chainOpt).toInt(), parser.value(shapesOpt).toInt()};
+    int iterations = std::max(parser.value(iterOpt).toInt(), 1);
+    // User buttons take the dense slots [0, buttons) and generated ones
+    // [buttons / 4, buttons / 4 + buttons / 2), so the user's reach furthest
+    if (scale.buttons < 0 || scale.buttons > _numUsableSlots) {
+        qCritical("At most %d buttons are supported.", _numUsableSlots);
+        return 1;
+    }
+
+    // Silence the per-button debug output of the parser
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &,
+                              const QString &msg) {
+        if (type != QtDebugMsg && type != QtInfoMsg && type != QtWarningMsg)
+            QTextStream(stderr) << msg << '\n';
+    });
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        qCritical("Cannot create a temporary directory.");
+        return 1;
+    }
+    QString userPath = dir.filePath("config.yaml");
+    QString generatedPath = dir.filePath("config.generated.yaml");
+    QString cachePath = dir.filePath("cache");
+    QString savePath = dir.filePath("saved.yaml");
+    // The generated config overrides half of the user's buttons
+    Scale generatedScale{
+        scale.buttons / 2, scale.defs / 10, scale.chainDepth,
+        scale.patternShapes};
+    if (!_writeFile(userPath, _genConfig(scale, 0, 'u'))
+        || !_writeFile(
+            generatedPath,
+            _genConfig(generatedScale, scale.buttons / 4, 'g'))) {
+        qCritical("Cannot write the synthetic configs.");
+        return 1;
+    }
+
+    _bench("config_parse", scale, iterations, [&] { Config config(userPath); });
+
+    _bench("configs_layering", scale, iterations, [&] {
+        Configs configs(userPath, generatedPath);
+    });
+
+    // The first load writes the snapshot, later ones map it
+    QDir().mkpath(cachePath);
+    Configs(userPath, generatedPath, cachePath);
+    _bench("configs_snapshot", scale, iterations, [&] {
+        Configs configs(userPath, generatedPath, cachePath);
+    });
+
+    Configs configs(userPath, generatedPath);
+    _bench("get_svg_defs", scale, iterations, [&] {
+        volatile qsizetype size = configs.getSvgDefs().size();
+        Q_UNUSED(size);
+    });
+
+    _bench("svg_def_graph", scale, iterations, [&] {
+        SvgDefGraph graph(configs.getSvgDefs());
+    });
+
+    QVector<Configs::Slot> buttonSlots;
+    for (int i = 0; i < scale.buttons; ++i)
+        buttonSlots.append(SlotIndex::slotAt(i));
+    _bench("gen_defs_svg", scale, iterations, [&] {
+        qsizetype size = 0;
+        for (Configs::Slot slot : buttonSlots)
+            if (const auto &button = configs.getButton(slot); button.info)
+                size +=
+                    button.info->genDefsSvg(configs.getSvgDefGraph()).size();
+        volatile qsizetype sink = size;
+        Q_UNUSED(sink);
+    });
+
+    Config userConfig(userPath);
+    _bench("save_roundtrip", scale, iterations, [&] {
+        userConfig.saveToFile(savePath);
+        Config config(savePath);
+    });
+
+    return 0;
+}
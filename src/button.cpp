@@ -14,6 +14,7 @@ Button::Button(
     QRectF geometry, QPolygonF maskPolygon, qreal hoverScale, QPointF centroid,
     QWidget *parent, QColor inactiveColor, QColor activeColor)
     : QPushButton(parent), inactiveGeometry(geometry),
+      hoverGeometry(genHoverGeometry(geometry, centroid, hoverScale)),
       inactiveMask(maskPolygon), hoverScale(hoverScale), centroid(centroid),
       bgOffset(geometry.topLeft() - geometry.toRect().topLeft()),
       inactiveBgColor(inactiveColor), activeBgColor(activeColor),
@@ -89,9 +90,6 @@ void Button::mouseReleaseEvent(QMouseEvent *e) {
 }
 
 void Button::resizeEvent(QResizeEvent *e) {
-    // transform icon
-    setIconSize(e->size());
-
     // Transform the mask. We paint the background polygon explicitly and offset
     // the mask by 2px so that the background edge can get antialiased. (There's
     // no antialias effect if we only mask the button with QRegion)
@@ -135,9 +133,26 @@ void Button::paintEvent(QPaintEvent *e) {
         painter.setPen(QPen(Qt::white, 5));
         painter.setBrush(Qt::transparent);
         painter.drawPolygon(inactiveMask * transform);
+        painter.setClipping(false);
+    }
+
+    // Paint the icon. Icons fit the sizes the button rests at, so only the
+    // activation animation scales them. The larger one scales down better.
+    const IconTile *tile = nullptr;
+    bool exact = false;
+    for (int state = numIconStates - 1; state >= 0 && !exact; --state) {
+        if (!iconTiles[state].atlas || iconTiles[state].atlas->isNull())
+            continue;
+        exact = stateSize(IconState(state)) == size();
+        if (!tile || exact)
+            tile = &iconTiles[state];
+    }
+    if (tile) {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, !exact);
+        painter.drawPixmap(QRectF(rect()), *tile->atlas, QRectF(tile->source));
     }
 
-    // Let parent object paint icons
+    // Let parent object paint the rest
     QPushButton::paintEvent(e);
 }
 
@@ -149,11 +164,53 @@ bool Button::isHovering() const {
     return hovering;
 }
 
+void Button::reset() {
+    hovering = leftClicked = rightClicked = false;
+
+    activationAnimations.stop();
+    geometryAnimation.setStartValue(inactiveGeometry);
+    geometryAnimation.setEndValue(inactiveGeometry);
+    bgColorAnimation.setStartValue(inactiveBgColor);
+    bgColorAnimation.setEndValue(inactiveBgColor);
+    // Restart from the inactive state. Stopped animations don't write the
+    // properties, so set them too.
+    activationAnimations.setCurrentTime(0);
+    setGeometry(inactiveGeometry.toRect());
+    setBgColor(inactiveBgColor);
+
+    disconnect(
+        &updateAnimation, &QPropertyAnimation::finished, nullptr, nullptr);
+    updateAnimation.stop();
+    setUpdateProgress(0);
+    updateAnimation.setStartValue(0);
+
+    lower();
+    update();
+}
+
 void Button::toggle() {
     leftClicked = !leftClicked;
     restartActivationAnimation();
 }
 
+QRect Button::genHoverGeometry(
+    const QRectF &geometry, const QPointF &centroid, qreal hoverScale) {
+    QPointF centroidOffset = centroid * (hoverScale - 1.);
+    QSizeF size = geometry.size() * hoverScale;
+    return QRectF(geometry.topLeft() - centroidOffset, size).toRect();
+}
+
+QSize Button::stateSize(IconState state) const {
+    return state == Hovered ? hoverGeometry.size()
+                            : inactiveGeometry.toRect().size();
+}
+
+void Button::setIconTile(
+    IconState state, const QPixmap *atlas, const QRect &source) {
+    iconTiles[state] = {atlas, source};
+    update();
+}
+
 const QColor &Button::getBgColor() const {
     return bgColor;
 }
@@ -168,12 +225,7 @@ void Button::restartActivationAnimation() {
     bgColorAnimation.setStartValue(bgColorAnimation.currentValue());
     if (hovering || leftClicked) {
         raise();
-        QPointF centroidOffset = centroid * (hoverScale - 1.);
-        geometryAnimation.setEndValue(
-            QRectF(
-                inactiveGeometry.topLeft() - centroidOffset,
-                inactiveGeometry.size() * hoverScale)
-                .toRect());
+        geometryAnimation.setEndValue(hoverGeometry);
         bgColorAnimation.setEndValue(activeBgColor);
     } else {
         lower();
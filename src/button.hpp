@@ -9,6 +9,7 @@
 #include <QPushButton>
 #include <QRegion>
 #include <QWeakPointer>
+#include <array>
 
 class Button : public QPushButton {
     Q_OBJECT
@@ -22,6 +23,34 @@ public:
     bool isActive() const;
     bool isHovering() const;
 
+    /// @brief The sizes the button rests at, each with its own icon
+    enum IconState : quint8 { Inactive, Hovered };
+    static constexpr int numIconStates = Hovered + 1;
+
+    /// @brief Geometry of a button when hovered or active
+    /// @param geometry Geometry when inactive
+    /// @param centroid See #centroid
+    static QRect genHoverGeometry(
+        const QRectF &geometry, const QPointF &centroid, qreal hoverScale);
+
+    /// @brief Size of the button in a state, once animations are over
+    QSize stateSize(IconState state) const;
+
+    /// @brief Draw the icon from a part of an image shared by many buttons
+    /// @param state The icon is drawn as is when the button is this size, and
+    /// scaled otherwise
+    /// @param atlas The shared image, or nullptr for no icon. It's not copied,
+    /// so that its owner can paint into it without detaching it, and must
+    /// outlive its use here.
+    /// @param source Where the icon of this button is in @p atlas, in device
+    /// pixels
+    void
+    setIconTile(IconState state, const QPixmap *atlas, const QRect &source);
+
+    /// @brief Go back to the inactive state at once, without animating,
+    /// as if the button had just been built. Icons are kept.
+    void reset();
+
 public slots:
     void toggle();
 
@@ -46,6 +75,8 @@ signals:
 
 public:
     const QRectF inactiveGeometry;
+    /// @see genHoverGeometry()
+    const QRect hoverGeometry;
     const QPolygonF inactiveMask;
     const qreal hoverScale;
     /// @brief The geometry center of the background
@@ -56,6 +87,13 @@ public:
     const QColor activeBgColor;
 
 private:
+    /// @see setIconTile()
+    struct IconTile {
+        const QPixmap *atlas = nullptr;
+        QRect source;
+    };
+    std::array<IconTile, numIconStates> iconTiles;
+
     QPoint mousePos;
     bool hovering;
     bool leftClicked;
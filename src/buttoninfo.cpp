@@ -2,11 +2,37 @@
 
 #include "constants.hpp"
 
-#include <QRegularExpression>
+#include <algorithm>
+
+Fingerprint &Fingerprint::operator<<(quint64 value) {
+    add(&value, sizeof(value));
+    return *this;
+}
+
+Fingerprint &Fingerprint::operator<<(const QByteArray &data) {
+    *this << quint64(data.size());
+    add(data.constData(), size_t(data.size()));
+    return *this;
+}
+
+Fingerprint &Fingerprint::operator<<(const QString &text) {
+    *this << quint64(text.size());
+    add(text.constData(), size_t(text.size()) * sizeof(QChar));
+    return *this;
+}
+
+void Fingerprint::add(const void *data, size_t size) {
+    constexpr quint64 prime = 0x100000001b3;
+    const auto *bytes = static_cast<const uchar *>(data);
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * prime;
+}
 
 void ButtonInfo::clear() {
     defIds.clear();
     customIconSvg.clear();
+    defsSvg.clear();
+    displayDefsSvg.clear();
 }
 
 ButtonInfo::operator bool() const {
@@ -21,6 +47,8 @@ ButtonInfo &ButtonInfo::operator+=(const ButtonInfo &other) {
     // Overwrite user-defined styles
     defIds.unite(other.defIds);
     customIconSvg = other.customIconSvg;
+    defsSvg.clear();
+    displayDefsSvg.clear();
     return *this;
 }
 
@@ -28,46 +56,60 @@ size_t ButtonInfo::hash(size_t seed) const {
     return qHash(defIds, seed) ^ qHash(customIconSvg, seed);
 }
 
+quint64 ButtonInfo::getFingerprint() const {
+    return fingerprint;
+}
+
+void ButtonInfo::updateFingerprint() {
+    Fingerprint hash;
+    addFingerprint(hash);
+    fingerprint = hash.result();
+}
+
+void ButtonInfo::addFingerprint(Fingerprint &out) const {
+    // Sets iterate in no particular order
+    QStringList ids = defIds.values();
+    std::sort(ids.begin(), ids.end());
+    out << quint64(ids.size());
+    for (const QString &id : ids)
+        out << id;
+    out << displayDefsSvg << customIconSvg;
+}
+
 ButtonInfo::ButtonInfo(
     const QSet<QString> &defIds, const QByteArray &customIconSvg)
     : defIds(defIds), customIconSvg(customIconSvg) {}
 
-QString ButtonInfo::genDefsSvg(const QHash<QString, QString> &svgDefs) const {
-    // Recursively add svg definitions and avoid duplicates
-    QString defs;
-    QList<QString> idsToAdd(defIds.begin(), defIds.end());
-    QSet<QString> idsAdded;
-    for (auto itr = idsToAdd.begin(); itr != idsToAdd.end(); ++itr) {
-        if (!svgDefs.contains(*itr))
-            continue;
-
-        defs.append(svgDefs.value(*itr));
-        idsAdded.insert(*itr);
-
-        static const QRegularExpression urlRegEx(
-            R"-(\burl\((?<op>['"]?)#(?<id>.*?)\k<op>\))-");
-        static const QRegularExpression hrefRegEx(
-            R"-(\bxlink:href=(?<op>['"]?)(?<id>.*?)\k<op>)-");
-
-        for (const QRegularExpression &re : {urlRegEx, hrefRegEx}) {
-            auto matchIter = re.globalMatch(svgDefs.value(*itr));
-            while (matchIter.hasNext()) {
-                QRegularExpressionMatch match = matchIter.next();
-                if (!idsAdded.contains(match.captured("id")))
-                    idsToAdd.append(match.captured("id"));
-            }
-        }
-    }
-    return defs;
+QString ButtonInfo::genDefsSvg(const SvgDefGraph &svgDefs) const {
+    return svgDefs.genDefsSvg(defIds);
+}
+
+void ButtonInfo::bindDefs(const SvgDefGraph &svgDefs) {
+    defsSvg = svgDefs.genDefsSvg(defIds);
+    displayDefsSvg = svgDefs.genDefsSvg(defIds, true);
+    updateFingerprint();
+}
+
+const QString &ButtonInfo::getDefsSvg() const {
+    return defsSvg;
+}
+
+const QString &ButtonInfo::getDisplayDefsSvg() const {
+    return displayDefsSvg;
 }
 
 const QByteArray &ButtonInfo::getIconSvg() const {
     return customIconSvg;
 }
 
+const QSet<QString> &ButtonInfo::getDefIds() const {
+    return defIds;
+}
+
 void CustomButtonInfo::clear() {
     ButtonInfo::clear();
     customStyleSvg.clear();
+    updateFingerprint();
 }
 
 bool CustomButtonInfo::isEmpty() const {
@@ -82,6 +124,7 @@ bool CustomButtonInfo::operator==(const CustomButtonInfo &other) const {
 CustomButtonInfo &CustomButtonInfo::operator+=(const CustomButtonInfo &other) {
     this->ButtonInfo::operator+=(other);
     customStyleSvg = other.customStyleSvg;
+    updateFingerprint();
     return *this;
 }
 
@@ -89,8 +132,7 @@ size_t CustomButtonInfo::hash(size_t seed) const {
     return this->ButtonInfo::hash(seed) ^ qHash(customStyleSvg, seed);
 }
 
-QByteArray
-CustomButtonInfo::genStyleSvg(const QHash<QString, QString> &svgDefs) const {
+QByteArray CustomButtonInfo::genStyleSvg(const SvgDefGraph &svgDefs) const {
     namespace BK = C::C::B::K;
     return QString(R"(<?xml version="1.0" encoding="UTF-8"?>)"
                    R"(<svg><defs>%1</defs>%2</svg>)")
@@ -98,10 +140,22 @@ CustomButtonInfo::genStyleSvg(const QHash<QString, QString> &svgDefs) const {
         .toUtf8();
 }
 
+CustomButtonInfo::CustomButtonInfo() {
+    updateFingerprint();
+}
+
 CustomButtonInfo::CustomButtonInfo(
     const QSet<QString> &defIds, const QByteArray &customStyleSvg,
     const QByteArray &customIconSvg)
-    : ButtonInfo(defIds, customIconSvg), customStyleSvg(customStyleSvg) {}
+    : ButtonInfo(defIds, customIconSvg), customStyleSvg(customStyleSvg) {
+    updateFingerprint();
+}
+
+void CustomButtonInfo::addFingerprint(Fingerprint &out) const {
+    ButtonInfo::addFingerprint(out);
+    // Tell the kinds apart
+    out << quint64(0) << customStyleSvg;
+}
 
 const QByteArray &CustomButtonInfo::getStyleSvg() const {
     return customStyleSvg;
@@ -114,6 +168,7 @@ void CustomButtonInfo::accept(ButtonInfoVisitor &visitor) {
 void StandardButtonInfo::clear() {
     ButtonInfo::clear();
     styleList.clear();
+    updateFingerprint();
 }
 
 bool StandardButtonInfo::isEmpty() const {
@@ -128,7 +183,8 @@ StandardButtonInfo &
 StandardButtonInfo::operator+=(const StandardButtonInfo &other) {
     // Merge standard styles
     this->ButtonInfo::operator+=(other);
-    styleList.insert(other.styleList);
+    styleList += other.styleList;
+    updateFingerprint();
     return *this;
 }
 
@@ -136,15 +192,12 @@ size_t StandardButtonInfo::hash(size_t seed) const {
     return this->ButtonInfo::hash(seed) ^ qHash(styleList, seed);
 }
 
-QByteArray
-StandardButtonInfo::genStyleSvg(const QHash<QString, QString> &svgDefs) const {
-    namespace BK = C::C::B::K;
-
+QByteArray StandardButtonInfo::genStyleSvg(const SvgDefGraph &svgDefs) const {
     // Generate style svg content
     QStringList styles;
-    for (const char *key : BK::basicStyles)
-        if (styleList.contains(key))
-            styles.append(key + (":" + styleList[key]));
+    styleList.forEach([&](StyleRecord::Key key, const QString &value) {
+        styles.append(StyleRecord::name(key) + (":" + value));
+    });
 
     // Combine them as style svg
     return QString(
@@ -158,20 +211,55 @@ void StandardButtonInfo::accept(ButtonInfoVisitor &visitor) {
     visitor.visit(*this);
 }
 
+StandardButtonInfo::StandardButtonInfo() {
+    updateFingerprint();
+}
+
 StandardButtonInfo::StandardButtonInfo(
     const QSet<QString> &defIds, const Config::StylesList &styles,
     const QByteArray &customIconSvg)
-    : ButtonInfo(defIds, customIconSvg), styleList(styles) {}
+    : ButtonInfo(defIds, customIconSvg), styleList(styles) {
+    updateFingerprint();
+}
+
+void StandardButtonInfo::addFingerprint(Fingerprint &out) const {
+    ButtonInfo::addFingerprint(out);
+    // Tell the kinds apart, and absent styles from empty ones
+    out << quint64(1) << quint64(styleList.mask());
+    styleList.forEach(
+        [&](StyleRecord::Key, const QString &value) { out << value; });
+}
 
 const Config::StylesList &StandardButtonInfo::styles() const {
     return styleList;
 }
 
-size_t qHash(const Config::StylesList &styles, size_t seed) {
-    size_t hash = ~(size_t)0;
-    for (auto itr = styles.begin(); itr != styles.end(); ++itr)
-        hash ^= qHash(itr.key(), seed) ^ qHash(itr.value(), seed);
-    return hash;
+QDataStream &operator<<(QDataStream &out, const ButtonInfo &info) {
+    return out << info.defIds << info.customIconSvg;
+}
+
+QDataStream &operator>>(QDataStream &in, ButtonInfo &info) {
+    return in >> info.defIds >> info.customIconSvg;
+}
+
+QDataStream &operator<<(QDataStream &out, const CustomButtonInfo &info) {
+    return out << static_cast<const ButtonInfo &>(info) << info.customStyleSvg;
+}
+
+QDataStream &operator>>(QDataStream &in, CustomButtonInfo &info) {
+    in >> static_cast<ButtonInfo &>(info) >> info.customStyleSvg;
+    info.updateFingerprint();
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const StandardButtonInfo &info) {
+    return out << static_cast<const ButtonInfo &>(info) << info.styleList;
+}
+
+QDataStream &operator>>(QDataStream &in, StandardButtonInfo &info) {
+    in >> static_cast<ButtonInfo &>(info) >> info.styleList;
+    info.updateFingerprint();
+    return in;
 }
 
 size_t qHash(const ButtonInfo &info, size_t seed) {
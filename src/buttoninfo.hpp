@@ -2,8 +2,10 @@
 #define BUTTONINFO_HPP
 
 #include "config.hpp"
+#include "svgdefgraph.hpp"
 #include "visitorpattern.hpp"
 
+#include <QDataStream>
 #include <QHash>
 #include <QSet>
 #include <QString>
@@ -12,6 +14,25 @@ class StandardButtonInfo;
 class CustomButtonInfo;
 using ButtonInfoVisitor = Visitor<StandardButtonInfo, CustomButtonInfo>;
 
+/// @brief Incremental 64-bit FNV-1a hash
+/// @details Strings are prefixed with their length, so that moving text from
+/// one field to the next changes the result.
+class Fingerprint {
+public:
+    Fingerprint &operator<<(quint64 value);
+    Fingerprint &operator<<(const QByteArray &data);
+    Fingerprint &operator<<(const QString &text);
+
+    quint64 result() const {
+        return hash;
+    }
+
+private:
+    void add(const void *data, size_t size);
+
+    quint64 hash = 0xcbf29ce484222325;
+};
+
 class ButtonInfo : public Visitable<ButtonInfoVisitor> {
 public:
     virtual void clear();
@@ -31,22 +52,51 @@ public:
     /// @return The hashed ButtonInfo
     virtual size_t hash(size_t seed = 0) const;
 
+    /// @brief Get #fingerprint
+    quint64 getFingerprint() const;
+
     ButtonInfo() = default;
     explicit ButtonInfo(
         const QSet<QString> &defIds, const QByteArray &customIconSvg);
 
     /// @brief Generate the style svg for copying to clipboard
-    /// @param svgDefs A map that map the id of defs to their bodies
-    virtual QByteArray
-    genStyleSvg(const QHash<QString, QString> &svgDefs) const = 0;
+    /// @param svgDefs All svg defs available
+    virtual QByteArray genStyleSvg(const SvgDefGraph &svgDefs) const = 0;
 
     /// @brief Generate the defs svg to be used in `<defs></defs>` block
-    /// @param svgDefs A map that map the id of defs to their bodies
-    QString genDefsSvg(const QHash<QString, QString> &svgDefs) const;
+    /// @param svgDefs All svg defs available
+    QString genDefsSvg(const SvgDefGraph &svgDefs) const;
+
+    /// @brief Generate and keep #defsSvg and #displayDefsSvg
+    /// @note Modifying this object drops them.
+    void bindDefs(const SvgDefGraph &svgDefs);
+
+    /// @brief Get #defsSvg. Returns empty string if not bound.
+    const QString &getDefsSvg() const;
+
+    /// @brief Get #displayDefsSvg. Returns empty string if not bound.
+    const QString &getDisplayDefsSvg() const;
 
     /// @brief Get #customIconSvg. Returns empty string if not available.
     const QByteArray &getIconSvg() const;
 
+    /// @brief Get #defIds, the defs directly used by this button
+    const QSet<QString> &getDefIds() const;
+
+    /// @{
+    /// @brief (De)serialize for binary config snapshots
+    friend QDataStream &operator<<(QDataStream &out, const ButtonInfo &info);
+    friend QDataStream &operator>>(QDataStream &in, ButtonInfo &info);
+    /// @}
+
+protected:
+    /// @brief Recompute #fingerprint, after every change
+    void updateFingerprint();
+
+    /// @brief Feed everything the icon of the button depends on
+    /// @note Overrides call this first
+    virtual void addFingerprint(Fingerprint &out) const;
+
 private:
     /// @brief Ids of the svg definitions used by this button
     /// @see Config::svgDefs
@@ -54,6 +104,20 @@ private:
 
     /// @brief The icon svg provided by the user
     QByteArray customIconSvg;
+
+    /// @brief Defs used by this button, including indirect ones
+    /// @details Derived from #defIds by bindDefs(), thus excluded from
+    /// comparison, hashing and serialization.
+    QString defsSvg;
+    /// @brief #defsSvg ready for rendering icons
+    /// @see SvgDefGraph::genDefsSvg
+    QString displayDefsSvg;
+
+    /// @brief Hash of the styles, the defs they use (once bound, including
+    /// indirect ones) and the icon svg
+    /// @details Buttons with equal fingerprints look the same, so it's what
+    /// icon caches are keyed by. Not serialized.
+    quint64 fingerprint = 0;
 };
 
 class CustomButtonInfo : public ButtonInfo {
@@ -63,17 +127,23 @@ public:
     bool operator==(const CustomButtonInfo &other) const;
     CustomButtonInfo &operator+=(const CustomButtonInfo &other);
     virtual size_t hash(size_t seed = 0) const override;
-    virtual QByteArray
-    genStyleSvg(const QHash<QString, QString> &svgDefs) const override;
+    virtual QByteArray genStyleSvg(const SvgDefGraph &svgDefs) const override;
     virtual void accept(ButtonInfoVisitor &visitor) override;
 
-    CustomButtonInfo() = default;
+    CustomButtonInfo();
     CustomButtonInfo(
         const QSet<QString> &defIds, const QByteArray &customStyleSvg,
         const QByteArray &customIconSvg);
 
     const QByteArray &getStyleSvg() const;
 
+    friend QDataStream &
+    operator<<(QDataStream &out, const CustomButtonInfo &info);
+    friend QDataStream &operator>>(QDataStream &in, CustomButtonInfo &info);
+
+protected:
+    virtual void addFingerprint(Fingerprint &out) const override;
+
 private:
     /// @brief This is a static svg for copy-pasting
     QByteArray customStyleSvg;
@@ -86,24 +156,29 @@ public:
     bool operator==(const StandardButtonInfo &other) const;
     StandardButtonInfo &operator+=(const StandardButtonInfo &other);
     virtual size_t hash(size_t seed = 0) const override;
-    virtual QByteArray
-    genStyleSvg(const QHash<QString, QString> &svgDefs) const override;
+    virtual QByteArray genStyleSvg(const SvgDefGraph &svgDefs) const override;
     virtual void accept(ButtonInfoVisitor &visitor) override;
 
-    StandardButtonInfo() = default;
+    StandardButtonInfo();
     StandardButtonInfo(
         const QSet<QString> &defIds, const Config::StylesList &styles,
         const QByteArray &customIconSvg);
 
     const Config::StylesList &styles() const;
 
+    friend QDataStream &
+    operator<<(QDataStream &out, const StandardButtonInfo &info);
+    friend QDataStream &operator>>(QDataStream &in, StandardButtonInfo &info);
+
+protected:
+    virtual void addFingerprint(Fingerprint &out) const override;
+
 private:
     /// @brief A list of key-value pairs
-    /// @details Key will be one of the constant in #C::CK::BK
+    /// @details Key will be one of #C::C::B::K::basicStyles
     Config::StylesList styleList;
 };
 
-size_t qHash(const Config::StylesList &styles, size_t seed = 0);
 size_t qHash(const ButtonInfo &info, size_t seed = 0);
 
 #endif // BUTTONINFO_HPP
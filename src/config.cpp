@@ -2,12 +2,14 @@
 
 #include "buttoninfo.hpp"
 #include "constants.hpp"
+#include "defaultconfigdata.hpp"
+#include "svgrefscanner.hpp"
 
 #include <QByteArray>
 #include <QDebug>
 #include <QFile>
 #include <QQueue>
-#include <QRegularExpression>
+#include <QSaveFile>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -49,6 +51,64 @@ struct convert<QColor> {
 };
 } // namespace YAML
 
+void Config::loadDefaultGlobalConfig() {
+    namespace DG = DefaultConfig::Global;
+
+    auto toStringList = []<size_t N>(const std::array<const char *, N> &list) {
+        QStringList result;
+        for (const char *elem : list)
+            result.append(QString::fromUtf8(elem));
+        return result;
+    };
+
+    shortcutMainPanel = QString::fromUtf8(DG::shortcutMainPanel);
+    shortcutTex = QString::fromUtf8(DG::shortcutTex);
+    shortcutCompiledTex = QString::fromUtf8(DG::shortcutCompiledTex);
+    buttonBgColorInactive = QColor(DG::buttonBgColorInactive);
+    buttonBgColorActive = QColor(DG::buttonBgColorActive);
+    guideColor = QColor(DG::guideColor);
+    panelMaxLevels = DG::panelMaxLevels;
+    panelRadius = DG::panelRadius;
+    defaultIconStyle = QString::fromUtf8(DG::defaultIconStyle);
+    defaultIconText = QString::fromUtf8(DG::defaultIconText);
+    texCompileTemplate = QString::fromUtf8(DG::texCompileTemplate);
+    texEditorCmd = toStringList(DG::texEditorCmd);
+    texCompileCmd = toStringList(DG::texCompileCmd);
+    pdfToSvgCmd = toStringList(DG::pdfToSvgCmd);
+    watchConfig = DG::watchConfig;
+    warmUpThreads = DG::warmUpThreads;
+    warmUpBudgetMs = DG::warmUpBudgetMs;
+    iconCacheMb = DG::iconCacheMb;
+}
+
+void Config::loadDefaultButtonsConfig() {
+    namespace DC = DefaultConfig;
+
+    for (const DC::SvgDef &def : DC::svgDefs)
+        svgDefs.insert(QString::fromUtf8(def.id), QString::fromUtf8(def.svg));
+
+    // The tables are checked at build time, no need to validate them again
+    for (const DC::Button &button : DC::buttons) {
+        QSet<QString> defIds;
+        for (size_t i = 0; i < button.numDefIds; ++i)
+            defIds.insert(QString::fromUtf8(DC::defIds[button.firstDefId + i]));
+
+        QByteArray customIcon(button.icon);
+        if (button.svg) {
+            customButtons.insert(
+                button.slot, {defIds, QByteArray(button.svg), customIcon});
+        } else {
+            StylesList styles;
+            for (size_t i = 0; i < button.numStyles; ++i) {
+                const DC::Style &style = DC::styles[button.firstStyle + i];
+                styles.insert(
+                    StylesList::Key(style.key), QString::fromUtf8(style.value));
+            }
+            standardButtons.insert(button.slot, {defIds, styles, customIcon});
+        }
+    }
+}
+
 void Config::parseGlobalConfig(const YAML::Node &config) {
     namespace CC = C::C;
     namespace GK = C::C::G::K;
@@ -75,6 +135,10 @@ void Config::parseGlobalConfig(const YAML::Node &config) {
         loadGlobalConfig(GK::defaultIconStyle, defaultIconStyle);
         loadGlobalConfig(GK::defaultIconText, defaultIconText);
         loadGlobalConfig(GK::texCompileTemplate, texCompileTemplate);
+        loadGlobalConfig(GK::watchConfig, watchConfig);
+        loadGlobalConfig(GK::warmUpThreads, warmUpThreads);
+        loadGlobalConfig(GK::warmUpBudgetMs, warmUpBudgetMs);
+        loadGlobalConfig(GK::iconCacheMb, iconCacheMb);
 
         auto loadStringList = [&](const char *key, QStringList &config) {
             if (!gConfig[key].IsDefined())
@@ -210,8 +274,7 @@ void Config::parseButtonsConfig(const YAML::Node &config) {
 
         // Check for validity and availability of slots
         Slot slot = button[BK::slot].as<Slot>();
-        if (pSlot(slot) > panelMaxLevels * 6 || tSlot(slot) > 5
-            || rSlot(slot) > 2 || subSlot(slot) > rSlot(slot) * 2) {
+        if (pSlot(slot) > panelMaxLevels * 6 || !SlotIndex::isValid(slot)) {
             qWarning(
                 "Button %s[%ld]:%s = %#x invalid, skipping...", CC::buttons,
                 numButtons, BK::slot, slot);
@@ -227,33 +290,6 @@ void Config::parseButtonsConfig(const YAML::Node &config) {
         // Load button styles
         qDebug("Registering button %#x", slot);
 
-        // A function to get a set of defs used in styles
-        auto genDefIds = [&, this](const QString &style) -> QSet<QString> {
-            // import elements in "<defs>...</defs>" when composing button
-            // styles
-            QSet<QString> defIds;
-            static const QRegularExpression urlRegEx(
-                R"-(\burl\((?<op>['"]?)#(?<id>.*?)\k<op>\))-");
-            auto matchIter = urlRegEx.globalMatch(style);
-            while (matchIter.hasNext()) {
-                QRegularExpressionMatch match = matchIter.next();
-                QString defId = match.captured("id");
-                if (svgDefs.contains(defId) && !defIds.contains(defId)) {
-                    defIds.insert(defId);
-                    qDebug(
-                        R"(Using svg def id="%s" for button %#x)",
-                        defId.toStdString().c_str(), slot);
-                } else if (!svgDefs.contains(defId)) {
-                    qWarning(
-                        R"(Button %s[%ld]:%s = %#x using a def id="%s" which )"
-                        R"(is not defined. Skipping importing this def...)",
-                        CC::buttons, numButtons, BK::slot, slot,
-                        defId.toStdString().c_str());
-                }
-            }
-            return defIds;
-        };
-
         // Get custom icon if available
         QByteArray customIcon;
         if (button[BK::customIcon].IsDefined())
@@ -262,21 +298,48 @@ void Config::parseButtonsConfig(const YAML::Node &config) {
         if (button[BK::customStyle].IsDefined()) {
             // Load non-standard styles
             QString style = button[BK::customStyle].as<QString>().toUtf8();
-            QSet<QString> defIds = genDefIds(style);
+            QSet<QString> defIds = genDefIds(slot, style);
             customButtons.insert(slot, {defIds, style.toUtf8(), customIcon});
         } else {
             // Load standard styles
-            QMap<QString, QString> styles;
-            for (const char *style : BK::basicStyles)
-                if (button[style].IsDefined())
-                    styles.insert(QString(style), button[style].as<QString>());
-            QSet<QString> defIds =
-                genDefIds(QStringList(styles.begin(), styles.end()).join(";"));
+            StylesList styles;
+            QStringList values;
+            for (int key = 0; key < StylesList::numKeys; ++key)
+                if (const char *style = BK::basicStyles[key];
+                    button[style].IsDefined()) {
+                    values.append(button[style].as<QString>());
+                    styles.insert(StylesList::Key(key), values.last());
+                }
+            QSet<QString> defIds = genDefIds(slot, values.join(";"));
             standardButtons.insert(slot, {defIds, styles, customIcon});
         }
     }
 }
 
+QSet<QString> Config::genDefIds(const Slot &slot, const QString &style) const {
+    namespace CC = C::C;
+    namespace BK = C::C::B::K;
+
+    // import elements in "<defs>...</defs>" when composing button styles
+    QSet<QString> defIds;
+    SvgRefScanner refs(style);
+    for (QStringView ref = refs.next(); !ref.isEmpty(); ref = refs.next()) {
+        QString defId = ref.toString();
+        if (!svgDefs.contains(defId)) {
+            qWarning(
+                R"(Button %s:%s = %#x using a def id="%s" which )"
+                R"(is not defined. Skipping importing this def...)",
+                CC::buttons, BK::slot, slot, defId.toStdString().c_str());
+        } else if (!defIds.contains(defId)) {
+            defIds.insert(defId);
+            qDebug(
+                R"(Using svg def id="%s" for button %#x)",
+                defId.toStdString().c_str(), slot);
+        }
+    }
+    return defIds;
+}
+
 quint8 Config::pSlot(const Slot &slot) {
     return (slot >> 24) & 0xff;
 }
@@ -294,18 +357,12 @@ quint8 Config::subSlot(const Slot &slot) {
 }
 
 Config::Config(const QString &file, QObject *parent) : QObject(parent) {
-    // Parse default config
+    // Load default config, which is compiled into the program
     qDebug("%s: Loading default config.", file.toStdString().c_str());
-    QFile baseConfig(":/res/default.yaml");
-    baseConfig.open(QFile::ReadOnly);
-    YAML::Node defaultConfig = YAML::Load(baseConfig.readAll().toStdString());
-    baseConfig.close();
-
-    parseGlobalConfig(defaultConfig);
+    loadDefaultGlobalConfig();
     if (file.isEmpty()) {
         // Only load svgdefs and buttons for default config (empty filename)
-        parseSvgDefsConfig(defaultConfig);
-        parseButtonsConfig(defaultConfig);
+        loadDefaultButtonsConfig();
         return;
     }
 
@@ -321,6 +378,29 @@ Config::Config(const QString &file, QObject *parent) : QObject(parent) {
     }
 }
 
+Config::Config(QDataStream &in, QObject *parent) : QObject(parent) {
+    // Keep the order in sync with operator<<
+    in >> shortcutMainPanel >> shortcutTex >> shortcutCompiledTex
+        >> buttonBgColorInactive >> buttonBgColorActive >> guideColor
+        >> panelMaxLevels >> panelRadius >> defaultIconStyle >> defaultIconText
+        >> texCompileTemplate >> texEditorCmd >> texCompileCmd >> pdfToSvgCmd
+        >> watchConfig >> warmUpThreads >> warmUpBudgetMs >> iconCacheMb;
+    in >> customButtons >> standardButtons >> svgDefs;
+}
+
+QDataStream &operator<<(QDataStream &out, const Config &config) {
+    out << config.shortcutMainPanel << config.shortcutTex
+        << config.shortcutCompiledTex << config.buttonBgColorInactive
+        << config.buttonBgColorActive << config.guideColor
+        << config.panelMaxLevels << config.panelRadius
+        << config.defaultIconStyle << config.defaultIconText
+        << config.texCompileTemplate << config.texEditorCmd
+        << config.texCompileCmd << config.pdfToSvgCmd << config.watchConfig
+        << config.warmUpThreads << config.warmUpBudgetMs << config.iconCacheMb;
+    out << config.customButtons << config.standardButtons << config.svgDefs;
+    return out;
+}
+
 const QHash<QString, QString> &Config::getSvgDefs() const {
     return svgDefs;
 }
@@ -336,43 +416,17 @@ void Config::updateStyle(
         if (!this->svgDefs.contains(key))
             this->svgDefs.insert(key, svgDefs[key]);
 
-    // A function to get a set of defs used in styles
-    auto genDefIds = [&](const QString &style) -> QSet<QString> {
-        // import elements in "<defs>...</defs>" when composing button
-        // styles
-        QSet<QString> defIds;
-        static const QRegularExpression urlRegEx(
-            R"-(\burl\((?<op>['"]?)#(?<id>.*?)\k<op>\))-");
-        auto matchIter = urlRegEx.globalMatch(style);
-        while (matchIter.hasNext()) {
-            QRegularExpressionMatch match = matchIter.next();
-            QString defId = match.captured("id");
-            if (svgDefs.contains(defId) && !defIds.contains(defId)) {
-                defIds.insert(defId);
-                qDebug(
-                    R"(Using svg def id="%s" for button %#x)",
-                    defId.toStdString().c_str(), slot);
-            } else if (!svgDefs.contains(defId)) {
-                qWarning(
-                    R"(Button %s:%s = %#x using a def id="%s" which )"
-                    R"(is not defined. Skipping importing this def...)",
-                    CC::buttons, BK::slot, slot, defId.toStdString().c_str());
-            }
-        }
-        return defIds;
-    };
-
     // Load standard styles
-    QMap<QString, QString> stylesToSave;
-    for (const char *key : BK::basicStyles)
-        if (styles.contains(key))
-            stylesToSave.insert(QString(key), styles[key]);
+    StylesList stylesToSave;
+    for (auto itr = styles.begin(); itr != styles.end(); ++itr)
+        if (std::optional<StylesList::Key> key = StylesList::keyOf(itr.key()))
+            stylesToSave.insert(*key, itr.value());
     QSet<QString> defIds =
-        genDefIds(QStringList(styles.begin(), styles.end()).join(";"));
+        genDefIds(slot, QStringList(styles.begin(), styles.end()).join(";"));
     standardButtons.insert(slot, {defIds, stylesToSave, {}});
 }
 
-void Config::saveToFile(const QString &file) {
+bool Config::saveToFile(const QString &file) const {
     namespace CC = C::C;
     namespace GK = C::C::G::K;
     namespace BK = C::C::B::K;
@@ -418,6 +472,10 @@ void Config::saveToFile(const QString &file) {
         for (const QString &cmd : pdfToSvgCmd)
             out << cmd.toStdString().c_str();
         out << EndSeq;
+        out << Key << GK::watchConfig << Value << watchConfig;
+        out << Key << GK::warmUpThreads << Value << warmUpThreads;
+        out << Key << GK::warmUpBudgetMs << Value << warmUpBudgetMs;
+        out << Key << GK::iconCacheMb << Value << iconCacheMb;
 
         out << EndMap;
     }
@@ -425,23 +483,24 @@ void Config::saveToFile(const QString &file) {
     // Write buttons section
     {
         out << Key << CC::buttons << Value << BeginSeq;
-        for (auto itr = standardButtons.constKeyValueBegin();
-             itr != standardButtons.constKeyValueEnd(); ++itr) {
-            out << BeginMap << Key << BK::slot << Value << Hex << itr->first;
-            const StylesList &styleList = itr->second.styles();
-            for (auto styleItr = styleList.constKeyValueBegin();
-                 styleItr != styleList.constKeyValueEnd(); ++styleItr)
-                out << Key << styleItr->first.toStdString().c_str() << Value
-                    << styleItr->second.toStdString().c_str();
+        for (qsizetype i = 0; i < standardButtons.size(); ++i) {
+            out << BeginMap << Key << BK::slot << Value << Hex
+                << standardButtons.keys()[i];
+            const StylesList &styleList = standardButtons.values()[i].styles();
+            styleList.forEach([&](StyleRecord::Key key, const QString &value) {
+                out << Key << StyleRecord::name(key) << Value
+                    << value.toStdString().c_str();
+            });
             out << EndMap;
         }
-        for (auto itr = customButtons.keyValueBegin();
-             itr != customButtons.keyValueEnd(); ++itr) {
-            out << BeginMap << Key << BK::slot << Value << itr->first;
-            if (QByteArray style = itr->second.getStyleSvg(); !style.isEmpty())
+        for (qsizetype i = 0; i < customButtons.size(); ++i) {
+            const CustomButtonInfo &info = customButtons.values()[i];
+            out << BeginMap << Key << BK::slot << Value
+                << customButtons.keys()[i];
+            if (QByteArray style = info.getStyleSvg(); !style.isEmpty())
                 out << Key << BK::customStyle << Value
                     << style.toStdString().c_str();
-            if (QByteArray icon = itr->second.getIconSvg(); !icon.isEmpty())
+            if (QByteArray icon = info.getIconSvg(); !icon.isEmpty())
                 out << Key << BK::customIcon << Value
                     << icon.toStdString().c_str();
             out << EndMap;
@@ -490,10 +549,17 @@ void Config::saveToFile(const QString &file) {
     // End document
     out << EndMap << EndDoc;
 
-    QFile outFile(file);
-    outFile.open(QFile::WriteOnly);
-    outFile.write(out.c_str());
-    outFile.close();
+    QSaveFile outFile(file);
+    if (!outFile.open(QFile::WriteOnly) || outFile.write(out.c_str()) < 0
+        || !outFile.commit()) {
+        qWarning("Failed to write %s.", file.toStdString().c_str());
+        return false;
+    }
+    return true;
+}
+
+QVector<Config::Slot> Config::buttonSlots() const {
+    return customButtons.keys() + standardButtons.keys();
 }
 
 bool Config::hasButton(const Slot &slot) const {
@@ -509,9 +575,9 @@ bool Config::hasStandardButton(const Slot &slot) const {
 }
 
 CustomButtonInfo Config::getCustomButton(const Slot &slot) const {
-    return customButtons[slot];
+    return customButtons.value(slot);
 }
 
 StandardButtonInfo Config::getStandardButton(const Slot &slot) const {
-    return standardButtons[slot];
+    return standardButtons.value(slot);
 }
@@ -1,7 +1,11 @@
 #ifndef CONFIGMANAGER_HPP
 #define CONFIGMANAGER_HPP
 
+#include "slotmap.hpp"
+#include "stylerecord.hpp"
+
 #include <QColor>
+#include <QDataStream>
 #include <QHash>
 #include <QIcon>
 #include <QMap>
@@ -21,7 +25,7 @@ class Config : public QObject {
 
 public:
     typedef quint32 Slot;
-    typedef QMap<QString, QString> StylesList;
+    typedef StyleRecord StylesList;
 
     bool hasButton(const Slot &slot) const;
     bool hasCustomButton(const Slot &slot) const;
@@ -32,12 +36,23 @@ public:
     /// @brief Read config from file
     explicit Config(const QString &file = "", QObject *parent = nullptr);
 
+    /// @brief Restore config from a binary snapshot
+    /// @details Check `in.status()` afterwards to tell if it succeeded.
+    /// @see ConfigCache
+    explicit Config(QDataStream &in, QObject *parent = nullptr);
+
+    /// @brief Write config to a binary snapshot
+    /// @see ConfigCache
+    friend QDataStream &operator<<(QDataStream &out, const Config &config);
+
     const QHash<QString, QString> &getSvgDefs() const;
 
     void updateStyle(
         const Slot &slot, const QHash<QString, QString> &styles,
         const QHash<QString, QString> &svgDefs = {});
-    void saveToFile(const QString &file);
+    /// @brief Write the config as yaml, replacing the file atomically
+    /// @return Whether succeeded
+    bool saveToFile(const QString &file) const;
 
     QString shortcutMainPanel;
     QString shortcutTex;
@@ -53,16 +68,31 @@ public:
     QStringList texEditorCmd;
     QStringList texCompileCmd;
     QStringList pdfToSvgCmd;
+    bool watchConfig;
+    quint32 warmUpThreads;
+    quint32 warmUpBudgetMs;
+    quint32 iconCacheMb;
+
+    /// @brief Slots of all buttons defined in this config
+    QVector<Slot> buttonSlots() const;
 
 private:
     /// @brief A list of buttons
-    QHash<Slot, CustomButtonInfo> customButtons;
-    QHash<Slot, StandardButtonInfo> standardButtons;
+    SlotMap<CustomButtonInfo> customButtons;
+    SlotMap<StandardButtonInfo> standardButtons;
 
     /// @brief A list of svg defs (e.g. gradient, pattern, marker)
     /// @details stores: {defId, def-content}...
     QHash<QString, QString> svgDefs;
 
+    /// @brief Load global configs from the compiled-in default config
+    /// @see DefaultConfig
+    void loadDefaultGlobalConfig();
+
+    /// @brief Load #svgDefs and buttons from the compiled-in default config
+    /// @see DefaultConfig
+    void loadDefaultButtonsConfig();
+
     /// @brief Parse global configs, initialize #guideColor, #panelRadius...
     /// @param config The root yaml node
     void parseGlobalConfig(const YAML::Node &config);
@@ -75,6 +105,10 @@ private:
     /// @param config The root yaml node
     void parseButtonsConfig(const YAML::Node &config);
 
+    /// @brief Collect ids of #svgDefs referenced in a style
+    /// @details Undefined ids are skipped with a warning.
+    QSet<QString> genDefIds(const Slot &slot, const QString &style) const;
+
     static inline quint8 pSlot(const Slot &slot);
     static inline quint8 tSlot(const Slot &slot);
     static inline quint8 rSlot(const Slot &slot);
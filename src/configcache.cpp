@@ -0,0 +1,127 @@
+#include "configcache.hpp"
+
+#include "constants.hpp"
+#include "defaultconfigdata.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QScopeGuard>
+
+/// @brief Magic number at the head of the snapshot file ("ISCS")
+static constexpr quint32 snapshotMagic = 0x49534353;
+
+ConfigCache::ConfigCache(
+    const QString &cachePath, const QStringList &layerFiles,
+    const QStringList &extraFiles)
+    : snapshotPath(
+        cachePath.isEmpty() ? QString()
+                            : cachePath + "/" + C::configCacheFile),
+      layerFiles(layerFiles), extraFiles(extraFiles), key(genKey()) {}
+
+QByteArray ConfigCache::genKey() const {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &path : layerFiles + extraFiles) {
+        // The default config is compiled in and only changes with the binary
+        if (path.isEmpty()) {
+            hash.addData(QByteArray(DefaultConfig::digest));
+            continue;
+        }
+
+        QFileInfo info(path);
+        hash.addData(path.toUtf8());
+        hash.addData(QByteArray::number(info.exists()));
+        if (!info.exists())
+            continue;
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(
+            QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+
+        QFile file(path);
+        if (file.open(QFile::ReadOnly))
+            hash.addData(&file);
+    }
+    return hash.result();
+}
+
+QVector<QSharedPointer<Config>> ConfigCache::load() const {
+    if (snapshotPath.isEmpty())
+        return {};
+
+    QFile file(snapshotPath);
+    if (!file.open(QFile::ReadOnly))
+        return {};
+
+    // Map the snapshot instead of reading it, most of it is copied into
+    // the configs right away.
+    uchar *data = file.map(0, file.size());
+    if (!data) {
+        qWarning(
+            "Cannot map config snapshot %s.",
+            snapshotPath.toStdString().c_str());
+        return {};
+    }
+    auto unmap = qScopeGuard([&] { file.unmap(data); });
+
+    QDataStream in(QByteArray::fromRawData(
+        reinterpret_cast<const char *>(data), int(file.size())));
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version;
+    QByteArray snapshotKey;
+    quint32 numLayers;
+    in >> magic >> version >> snapshotKey >> numLayers;
+    if (in.status() != QDataStream::Ok || magic != snapshotMagic
+        || version != C::configCacheVersion || snapshotKey != key
+        || numLayers != quint32(layerFiles.size())) {
+        qDebug("Config snapshot is stale, reparsing configs.");
+        return {};
+    }
+
+    QVector<QSharedPointer<Config>> layers;
+    for (quint32 i = 0; i < numLayers; ++i)
+        layers.append(QSharedPointer<Config>(new Config(in)));
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning(
+            "Config snapshot %s is corrupted, reparsing configs.",
+            snapshotPath.toStdString().c_str());
+        return {};
+    }
+
+    qDebug(
+        "Configs loaded from snapshot %s", snapshotPath.toStdString().c_str());
+    return layers;
+}
+
+void ConfigCache::save(const QVector<QSharedPointer<Config>> &layers) const {
+    if (snapshotPath.isEmpty())
+        return;
+    Q_ASSERT(layers.size() == layerFiles.size());
+
+    // Write to a temporary file first so a crash never leaves a half-written
+    // snapshot behind
+    QSaveFile file(snapshotPath);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning(
+            "Cannot write config snapshot %s.",
+            snapshotPath.toStdString().c_str());
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << snapshotMagic << C::configCacheVersion << key
+        << quint32(layers.size());
+    for (const QSharedPointer<Config> &layer : layers)
+        out << *layer;
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qWarning(
+            "Failed to write config snapshot %s.",
+            snapshotPath.toStdString().c_str());
+}
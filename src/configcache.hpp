@@ -0,0 +1,48 @@
+#ifndef CONFIGCACHE_HPP
+#define CONFIGCACHE_HPP
+
+#include "config.hpp"
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// @brief A binary snapshot of all parsed config layers.
+/// @details The snapshot is keyed by the mtime and content hash of every
+/// layer. It is written after a successful parse and memory-mapped on the next
+/// start, so that startup skips yaml-cpp entirely when nothing changed.
+class ConfigCache {
+public:
+    /// @param cachePath The directory to store the snapshot in. Caching is
+    /// disabled if this is empty.
+    /// @param layerFiles Config files of all layers, ordered by precedence.
+    /// An empty entry stands for the default (embedded) config.
+    /// @param extraFiles Other files the layers are built from, e.g. journals
+    ConfigCache(
+        const QString &cachePath, const QStringList &layerFiles,
+        const QStringList &extraFiles = {});
+
+    /// @brief Load all layers from the snapshot
+    /// @return The layers in the order of #layerFiles, or an empty vector if
+    /// the snapshot is missing, stale, or corrupted.
+    QVector<QSharedPointer<Config>> load() const;
+
+    /// @brief Store all layers to the snapshot
+    /// @param layers The layers in the order of #layerFiles
+    void save(const QVector<QSharedPointer<Config>> &layers) const;
+
+private:
+    /// @brief Hash the mtime and content of all #layerFiles and #extraFiles
+    QByteArray genKey() const;
+
+    const QString snapshotPath;
+    const QStringList layerFiles;
+    const QStringList extraFiles;
+
+    /// @brief Identifies the state of #layerFiles this snapshot is built from
+    const QByteArray key;
+};
+
+#endif // CONFIGCACHE_HPP
@@ -0,0 +1,160 @@
+#include "configjournal.hpp"
+
+#include "constants.hpp"
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+/// @brief Write an entry as a single line of flow-style yaml
+static QByteArray _serializeEntry(const ConfigJournal::Entry &entry) {
+    namespace JK = C::C::J::K;
+    using YAML::BeginMap, YAML::EndMap, YAML::Key, YAML::Value,
+        YAML::DoubleQuoted;
+
+    YAML::Emitter out;
+    out << YAML::Flow << BeginMap;
+    out << Key << JK::slot << Value << YAML::Hex << entry.slot;
+    auto writeMap = [&](const char *key, const QHash<QString, QString> &map) {
+        out << Key << key << Value << BeginMap;
+        for (auto itr = map.begin(); itr != map.end(); ++itr)
+            out << Key << DoubleQuoted << itr.key().toStdString() << Value
+                << DoubleQuoted << itr.value().toStdString();
+        out << EndMap;
+    };
+    writeMap(JK::styles, entry.styles);
+    writeMap(JK::svgDefs, entry.svgDefs);
+    out << EndMap;
+
+    // Line breaks in values are escaped, the rest are mere whitespace
+    return QByteArray(out.c_str()).replace('\n', ' ') + '\n';
+}
+
+ConfigJournal::ConfigJournal(const QString &configFile)
+    : configFile(configFile),
+      journalFile(configFile + C::configJournalSuffix),
+      compactingFile(configFile + C::configCompactingSuffix),
+      numEntries(countEntries(journalFile) + countEntries(compactingFile)) {}
+
+QStringList ConfigJournal::files() const {
+    return {compactingFile, journalFile};
+}
+
+void ConfigJournal::replay(Config &config) const {
+    // Older entries first
+    replayFile(compactingFile, config);
+    replayFile(journalFile, config);
+}
+
+void ConfigJournal::replayFile(const QString &file, Config &config) {
+    namespace JK = C::C::J::K;
+
+    QFile journal(file);
+    if (!journal.open(QFile::ReadOnly))
+        return;
+
+    qsizetype numLines = 0, numReplayed = 0;
+    while (!journal.atEnd()) {
+        QByteArray line = journal.readLine();
+        ++numLines;
+        if (line.trimmed().isEmpty())
+            continue;
+
+        // A crash may leave a partial entry at the end, skip broken ones
+        try {
+            YAML::Node entry = YAML::Load(line.toStdString());
+            if (!entry.IsMap() || !entry[JK::slot].IsDefined())
+                throw std::runtime_error("not an entry");
+
+            auto readMap = [&](const char *key) {
+                QHash<QString, QString> map;
+                for (const auto &elem : entry[key])
+                    map.insert(
+                        QString::fromStdString(elem.first.as<std::string>()),
+                        QString::fromStdString(elem.second.as<std::string>()));
+                return map;
+            };
+            Slot slot = entry[JK::slot].as<Slot>();
+            if (!SlotIndex::isValid(slot))
+                throw std::runtime_error("invalid slot");
+            config.updateStyle(
+                slot, readMap(JK::styles), readMap(JK::svgDefs));
+            ++numReplayed;
+        } catch (std::exception &e) {
+            qWarning(
+                "%s:%lld: Invalid journal entry skipped: %s",
+                file.toStdString().c_str(), qlonglong(numLines), e.what());
+        }
+    }
+    qDebug(
+        "%s: %lld entries replayed", file.toStdString().c_str(),
+        qlonglong(numReplayed));
+}
+
+qsizetype ConfigJournal::countEntries(const QString &file) {
+    QFile journal(file);
+    if (!journal.open(QFile::ReadOnly))
+        return 0;
+    return journal.readAll().count('\n');
+}
+
+bool ConfigJournal::append(const QVector<Entry> &entries) {
+    if (entries.isEmpty())
+        return true;
+
+    QByteArray data;
+    for (const Entry &entry : entries)
+        data += _serializeEntry(entry);
+
+    QFile journal(journalFile);
+    if (!journal.open(QFile::WriteOnly | QFile::Append)
+        || journal.write(data) != data.size() || !journal.flush()) {
+        qWarning(
+            "Failed to write journal %s.", journalFile.toStdString().c_str());
+        return false;
+    }
+    numEntries += entries.size();
+    return true;
+}
+
+qsizetype ConfigJournal::size() const {
+    return numEntries;
+}
+
+bool ConfigJournal::hasLeftover() const {
+    return QFile::exists(compactingFile);
+}
+
+bool ConfigJournal::compact(const Config &config) {
+    // Move the journal aside first, so that a crash while writing the config
+    // leaves it to be replayed. Merge it into the leftover of an interrupted
+    // compaction, if any.
+    if (!QFile::exists(compactingFile)) {
+        if (QFile::exists(journalFile)
+            && !QFile::rename(journalFile, compactingFile)) {
+            qWarning(
+                "Cannot move journal %s aside.",
+                journalFile.toStdString().c_str());
+            return false;
+        }
+    } else if (QFile journal(journalFile); journal.open(QFile::ReadOnly)) {
+        QFile leftover(compactingFile);
+        QByteArray data = journal.readAll();
+        if (!leftover.open(QFile::WriteOnly | QFile::Append)
+            || leftover.write(data) != data.size() || !leftover.flush()) {
+            qWarning(
+                "Cannot merge journal %s.", journalFile.toStdString().c_str());
+            return false;
+        }
+        journal.remove();
+    }
+
+    if (!config.saveToFile(configFile))
+        return false;
+    QFile::remove(compactingFile);
+    numEntries = 0;
+    qDebug("Journal folded into %s", configFile.toStdString().c_str());
+    return true;
+}
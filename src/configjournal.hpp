@@ -0,0 +1,72 @@
+#ifndef CONFIGJOURNAL_HPP
+#define CONFIGJOURNAL_HPP
+
+#include "config.hpp"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// @brief An append-only log of changes to a config file.
+/// @details Each Config::updateStyle() is recorded as one line of flow-style
+/// yaml, so that saving a style costs a single append no matter how large the
+/// config is. The journal is replayed on load, and folded into the config file
+/// once it grows long enough (see compact()).
+///
+/// Compaction renames the journal aside before rewriting the config file and
+/// removes it afterwards, so new entries never get lost. Should it be
+/// interrupted, the leftover is replayed before the journal on the next load.
+/// Replaying an entry twice is harmless.
+class ConfigJournal {
+public:
+    using Slot = Config::Slot;
+
+    /// @brief Arguments of a Config::updateStyle() call
+    struct Entry {
+        Slot slot;
+        QHash<QString, QString> styles;
+        QHash<QString, QString> svgDefs;
+    };
+
+    /// @param configFile The config file this journal belongs to
+    explicit ConfigJournal(const QString &configFile);
+
+    /// @brief The journal files, which the state of the config depends on
+    QStringList files() const;
+
+    /// @brief Apply all recorded entries to a config loaded from #configFile
+    void replay(Config &config) const;
+
+    /// @brief Record entries
+    /// @return Whether the entries have been written
+    bool append(const QVector<Entry> &entries);
+
+    /// @brief Number of recorded entries
+    qsizetype size() const;
+
+    /// @brief Tell whether an interrupted compaction left a journal behind
+    bool hasLeftover() const;
+
+    /// @brief Fold the journal into #configFile
+    /// @param config The up-to-date config, including all recorded entries
+    /// @return Whether succeeded
+    bool compact(const Config &config);
+
+private:
+    /// @brief Apply entries recorded in a journal file
+    static void replayFile(const QString &file, Config &config);
+
+    /// @brief Count entries recorded in a journal file
+    static qsizetype countEntries(const QString &file);
+
+    const QString configFile;
+    const QString journalFile;
+    /// @brief The journal being folded into #configFile
+    const QString compactingFile;
+
+    /// @brief Number of entries in #journalFile and #compactingFile
+    qsizetype numEntries;
+};
+
+#endif // CONFIGJOURNAL_HPP
@@ -1,19 +1,87 @@
 #include "configs.hpp"
 
 #include "buttoninfo.hpp"
+#include "configcache.hpp"
+#include "constants.hpp"
 
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
 #include <algorithm>
+#include <array>
+#include <exception>
+
+QVector<QSharedPointer<Config>> Configs::loadConfigs(
+    const QString &userConfigPath, const QString &generatedConfigPath,
+    const ConfigJournal &generatedJournal, const QString &cachePath) {
+    ConfigCache cache(
+        cachePath, {generatedConfigPath, userConfigPath, ""},
+        generatedJournal.files());
+    if (QVector<QSharedPointer<Config>> configs = cache.load();
+        !configs.isEmpty())
+        return configs;
+
+    // The layers are independent until composed, so parse them concurrently
+    std::array<QSharedPointer<Config>, Default + 1> layers;
+    // Parse errors must not escape pool threads, they are rethrown once all
+    // layers are done
+    std::array<std::exception_ptr, Default + 1> errors;
+    QThread *ownerThread = QThread::currentThread();
+    auto load = [&](Layer layer, const QString &path) {
+        try {
+            QElapsedTimer timer;
+            timer.start();
+            auto config = QSharedPointer<Config>::create(path);
+            if (layer == Generated)
+                generatedJournal.replay(*config);
+            config->moveToThread(ownerThread);
+            layers[layer] = config;
+            qDebug(
+                "Config layer %s loaded in %lld ms",
+                path.isEmpty() ? "<default>" : path.toStdString().c_str(),
+                qlonglong(timer.elapsed()));
+        } catch (...) {
+            errors[layer] = std::current_exception();
+        }
+    };
+
+    QThreadPool pool;
+    pool.start([&] { load(Generated, generatedConfigPath); });
+    pool.start([&] { load(User, userConfigPath); });
+    // The default layer is compiled in and cheap, load it meanwhile
+    load(Default, "");
+    pool.waitForDone();
+    for (const std::exception_ptr &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+
+    QVector<QSharedPointer<Config>> configs{
+        layers[Generated], layers[User], layers[Default]};
+    cache.save(configs);
+    return configs;
+}
 
 Configs::Configs(
     const QString &userConfigPath, const QString &generatedConfigPath,
-    QObject *parent)
-    : QObject{parent},
-      configs{
-          QSharedPointer<Config>(new Config(generatedConfigPath)),
-          QSharedPointer<Config>(new Config(userConfigPath)),
-          QSharedPointer<Config>(new Config)},
-      generatedConfig(*configs[0]), userConfig(*configs[1]),
-      defaultConfig(*configs[2]), generatedConfigPath(generatedConfigPath) {
+    const QString &cachePath, QObject *parent)
+    : QObject{parent}, userConfigPath(userConfigPath),
+      generatedConfigPath(generatedConfigPath) {
+    QSharedPointer<ConfigJournal> generatedJournal(
+        new ConfigJournal(generatedConfigPath));
+    configs = loadConfigs(
+        userConfigPath, generatedConfigPath, *generatedJournal, cachePath);
+    composeGlobalConfig();
+    mergeSvgDefs();
+    resolveButtons();
+
+    generatedWriter =
+        new ConfigWriter(generatedJournal, *configs[Generated], this);
+}
+
+void Configs::composeGlobalConfig() {
+    const Config &defaultConfig = *configs[Default];
 
     // compose entries from underlying configs
     auto loadEntry = [&, this]<typename T>(T &result, T Config::*entryPtr) {
@@ -39,55 +107,189 @@ Configs::Configs(
     loadEntry(texEditorCmd, &Config::texEditorCmd);
     loadEntry(texCompileCmd, &Config::texCompileCmd);
     loadEntry(pdfToSvgCmd, &Config::pdfToSvgCmd);
+    loadEntry(watchConfig, &Config::watchConfig);
+    loadEntry(warmUpThreads, &Config::warmUpThreads);
+    loadEntry(warmUpBudgetMs, &Config::warmUpBudgetMs);
+    loadEntry(iconCacheMb, &Config::iconCacheMb);
 }
 
-bool Configs::hasButton(const Slot &slot) const {
-    return std::any_of(configs.begin(), configs.end(), [&](const auto &c) {
-        return c->hasButton(slot);
+void Configs::mergeSvgDefs() {
+    QHash<QString, QString> svgDefs;
+    std::for_each(configs.crbegin(), configs.crend(), [&](const auto &c) {
+        svgDefs.insert(c->getSvgDefs());
     });
+    mergedSvgDefs = std::move(svgDefs);
+}
+
+void Configs::resolveButtons() {
+    svgDefGraph = SvgDefGraph(mergedSvgDefs);
+    resolvedButtons.clear();
+    for (const auto &c : configs)
+        for (const Slot &slot : c->buttonSlots())
+            if (!resolvedButtons.contains(slot))
+                resolvedButtons.insert(slot, resolveButton(slot));
+}
+
+Configs::ResolvedButton Configs::resolveButton(const Slot &slot) const {
+    auto standard = std::find_if(
+        configs.begin(), configs.end(),
+        [&](const auto &c) { return c->hasStandardButton(slot); });
+    if (standard != configs.end()) {
+        auto info = QSharedPointer<StandardButtonInfo>::create(
+            (*standard)->getStandardButton(slot));
+        info->bindDefs(svgDefGraph);
+        return {SlotKind::Standard, info};
+    }
+
+    auto custom = std::find_if(
+        configs.begin(), configs.end(),
+        [&](const auto &c) { return c->hasCustomButton(slot); });
+    if (custom != configs.end()) {
+        auto info = QSharedPointer<CustomButtonInfo>::create(
+            (*custom)->getCustomButton(slot));
+        info->bindDefs(svgDefGraph);
+        return {SlotKind::Custom, info};
+    }
+
+    return {};
+}
+
+const Configs::ResolvedButton &Configs::getButton(const Slot &slot) const {
+    static const ResolvedButton none;
+    const ResolvedButton *button = resolvedButtons.find(slot);
+    return button ? *button : none;
+}
+
+const QVector<Configs::Slot> &Configs::buttonSlots() const {
+    return resolvedButtons.keys();
+}
+
+bool Configs::hasButton(const Slot &slot) const {
+    return getButton(slot).kind != SlotKind::None;
 }
 
 bool Configs::hasCustomButton(const Slot &slot) const {
-    return std::any_of(configs.begin(), configs.end(), [&](const auto &c) {
-        return c->hasCustomButton(slot);
-    });
+    return getButton(slot).kind == SlotKind::Custom;
 }
 
 bool Configs::hasStandardButton(const Slot &slot) const {
-    return std::any_of(configs.begin(), configs.end(), [&](const auto &c) {
-        return c->hasStandardButton(slot);
-    });
+    return getButton(slot).kind == SlotKind::Standard;
 }
 
-CustomButtonInfo Configs::getCustomButton(const Slot &slot) const {
-    return (*std::find_if(
-                configs.begin(), configs.end(),
-                [&](const auto &c) { return c->hasCustomButton(slot); }))
-        ->getCustomButton(slot);
+const CustomButtonInfo &Configs::getCustomButton(const Slot &slot) const {
+    return getButton(slot).custom();
 }
 
-StandardButtonInfo Configs::getStandardButton(const Slot &slot) const {
-    return (*std::find_if(
-                configs.begin(), configs.end(),
-                [&](const auto &c) { return c->hasStandardButton(slot); }))
-        ->getStandardButton(slot);
+const StandardButtonInfo &Configs::getStandardButton(const Slot &slot) const {
+    return getButton(slot).standard();
 }
 
-QHash<QString, QString> Configs::getSvgDefs() const {
-    // Stack the svgDefs and return
-    QHash<QString, QString> svgDefs;
-    std::for_each(configs.crbegin(), configs.crend(), [&](const auto &c) {
-        svgDefs.insert(c->getSvgDefs());
-    });
-    return svgDefs;
+const QHash<QString, QString> &Configs::getSvgDefs() const {
+    return mergedSvgDefs;
+}
+
+const SvgDefGraph &Configs::getSvgDefGraph() const {
+    return svgDefGraph;
 }
 
 void Configs::updateGeneratedConfig(
     const Slot &slot, const QHash<QString, QString> &styles,
     const QHash<QString, QString> &svgDefs) {
-    generatedConfig.updateStyle(slot, styles, svgDefs);
+    configs[Generated]->updateStyle(slot, styles, svgDefs);
+    unsavedEntries.append({slot, styles, svgDefs});
+
+    // Only the given defs may have changed. The generated layer is on top,
+    // and keeps its existing defs.
+    const QHash<QString, QString> &generatedDefs =
+        configs[Generated]->getSvgDefs();
+    bool defsChanged = false;
+    for (auto itr = svgDefs.begin(); itr != svgDefs.end(); ++itr) {
+        QString def = generatedDefs.value(itr.key());
+        if (mergedSvgDefs.value(itr.key()) != def) {
+            mergedSvgDefs.insert(itr.key(), def);
+            defsChanged = true;
+        }
+    }
+
+    // New defs may be used by other buttons as well
+    if (defsChanged)
+        resolveButtons();
+    else
+        resolvedButtons.insert(slot, resolveButton(slot));
 }
 
 void Configs::saveGeneratedConfig() {
-    generatedConfig.saveToFile(generatedConfigPath);
+    generatedWriter->save(unsavedEntries);
+    unsavedEntries.clear();
+}
+
+void Configs::flushGeneratedConfig() {
+    generatedWriter->flush();
+}
+
+void Configs::watchUserConfig() {
+    if (userConfigWatcher)
+        return;
+
+    reloadTimer = new QTimer(this);
+    reloadTimer->setSingleShot(true);
+    reloadTimer->setInterval(C::configReloadDelayMs);
+    connect(reloadTimer, &QTimer::timeout, this, &Configs::reloadUserConfig);
+
+    // Also watch the directory, since many editors save by replacing the file,
+    // which drops it from the watcher.
+    userConfigWatcher = new QFileSystemWatcher(this);
+    userConfigWatcher->addPath(QFileInfo(userConfigPath).absolutePath());
+    if (QFile::exists(userConfigPath))
+        userConfigWatcher->addPath(userConfigPath);
+
+    auto scheduleReload = [this] {
+        if (QFile::exists(userConfigPath)
+            && !userConfigWatcher->files().contains(userConfigPath))
+            userConfigWatcher->addPath(userConfigPath);
+        reloadTimer->start();
+    };
+    connect(
+        userConfigWatcher, &QFileSystemWatcher::fileChanged, this,
+        scheduleReload);
+    connect(
+        userConfigWatcher, &QFileSystemWatcher::directoryChanged, this,
+        [this, scheduleReload] {
+            // Ignore changes to other files in the same directory
+            if (QFile::exists(userConfigPath)
+                != userConfigWatcher->files().contains(userConfigPath))
+                scheduleReload();
+        });
+}
+
+void Configs::reloadUserConfig() {
+    qDebug("Reloading %s", userConfigPath.toStdString().c_str());
+
+    QSharedPointer<Config> newUserConfig;
+    try {
+        newUserConfig = QSharedPointer<Config>(new Config(userConfigPath));
+    } catch (std::exception &e) {
+        qWarning(
+            "Failed to reload %s: %s. Keeping the old config.",
+            userConfigPath.toStdString().c_str(), e.what());
+        return;
+    }
+
+    QString oldIconStyle = defaultIconStyle;
+    QString oldIconText = defaultIconText;
+
+    configs[User] = newUserConfig;
+    composeGlobalConfig();
+    mergeSvgDefs();
+    resolveButtons();
+
+    if (defaultIconStyle != oldIconStyle || defaultIconText != oldIconText) {
+        emit allIconsInvalidated();
+        return;
+    }
+
+    // Icons are keyed by the content of their styles and defs, so the changed
+    // buttons need not be told apart
+    qDebug("User config reloaded");
+    emit iconsInvalidated();
 }
@@ -1,29 +1,72 @@
 #ifndef CONFIGS_HPP
 #define CONFIGS_HPP
 
+#include "buttoninfo.hpp"
 #include "config.hpp"
+#include "configjournal.hpp"
+#include "configwriter.hpp"
 
+#include <QFileSystemWatcher>
 #include <QObject>
 #include <QSharedPointer>
 #include <QString>
+#include <QTimer>
 #include <QVector>
 
 class Configs : public QObject {
     Q_OBJECT
 public:
+    /// @param cachePath Where to keep the parsed config snapshot. Empty
+    /// to always parse the config files.
     explicit Configs(
         const QString &userConfigPath, const QString &generatedConfigPath,
-        QObject *parent = nullptr);
+        const QString &cachePath = "", QObject *parent = nullptr);
 
     using Slot = Config::Slot;
 
+    /// @brief Which kind of button a slot resolves to
+    enum class SlotKind : quint8 { None, Standard, Custom };
+
+    /// @brief The effective button of a slot after stacking all layers
+    struct ResolvedButton {
+        SlotKind kind = SlotKind::None;
+        /// @brief A StandardButtonInfo or CustomButtonInfo according to #kind.
+        /// Null if #kind is SlotKind::None.
+        QSharedPointer<const ButtonInfo> info;
+
+        const StandardButtonInfo &standard() const {
+            Q_ASSERT(kind == SlotKind::Standard);
+            return static_cast<const StandardButtonInfo &>(*info);
+        }
+        const CustomButtonInfo &custom() const {
+            Q_ASSERT(kind == SlotKind::Custom);
+            return static_cast<const CustomButtonInfo &>(*info);
+        }
+    };
+
+    /// @brief Look up the effective button of a slot
+    /// @return The resolved entry, with SlotKind::None if no layer defines
+    /// the slot. The reference stays valid until the configs are modified.
+    const ResolvedButton &getButton(const Slot &slot) const;
+
+    /// @brief Slots of all buttons defined in any layer, in no particular
+    /// order
+    const QVector<Slot> &buttonSlots() const;
+
     bool hasButton(const Slot &slot) const;
     bool hasCustomButton(const Slot &slot) const;
     bool hasStandardButton(const Slot &slot) const;
-    CustomButtonInfo getCustomButton(const Slot &slot) const;
-    StandardButtonInfo getStandardButton(const Slot &slot) const;
+    const CustomButtonInfo &getCustomButton(const Slot &slot) const;
+    const StandardButtonInfo &getStandardButton(const Slot &slot) const;
+
+    /// @brief Get the svg defs of all layers, upper layers taking precedence
+    /// @details The merged defs are kept up to date as layers change. The
+    /// reference stays valid until the configs are modified, copy it (which
+    /// is cheap, as QHash is implicitly shared) to keep a version around.
+    const QHash<QString, QString> &getSvgDefs() const;
 
-    QHash<QString, QString> getSvgDefs() const;
+    /// @brief Get the svg defs of all layers, with references resolved
+    const SvgDefGraph &getSvgDefGraph() const;
 
     QString shortcutMainPanel;
     QString shortcutTex;
@@ -39,27 +82,89 @@ public:
     QStringList texEditorCmd;
     QStringList texCompileCmd;
     QStringList pdfToSvgCmd;
+    bool watchConfig;
+    quint32 warmUpThreads;
+    quint32 warmUpBudgetMs;
+    quint32 iconCacheMb;
 
     /// @brief Update Generated Config
     void updateGeneratedConfig(
         const Slot &slot, const QHash<QString, QString> &styles,
         const QHash<QString, QString> &svgDefs = {});
 
-    /// @brief Save the #generatedConfig to #generatedConfigPath
+    /// @brief Save updates of the generated config in the background
+    /// @see ConfigWriter
     void saveGeneratedConfig();
 
+    /// @brief Wait until all saves of the generated config are on disk
+    void flushGeneratedConfig();
+
+    /// @brief Watch the user config file and reload it whenever it changes
+    /// @note Changes are only picked up while the event loop is running.
+    void watchUserConfig();
+
+signals:
+    /// @brief Emitted after a reload, which may have changed any button
+    void iconsInvalidated();
+
+    /// @brief Emitted after a reload changed the look of all icons
+    void allIconsInvalidated();
+
 private:
+    /// @brief Re-parse the user config and announce that icons may have
+    /// changed
+    void reloadUserConfig();
+
+    /// @brief Compose global entries (#guideColor, ...) from all layers
+    void composeGlobalConfig();
+
+    /// @brief Rebuild #mergedSvgDefs from all layers
+    void mergeSvgDefs();
+
+    /// @brief Rebuild #svgDefGraph and #resolvedButtons from all layers
+    void resolveButtons();
+
+    /// @brief Resolve a single slot from all layers
+    /// @details The button info is bound to #svgDefGraph.
+    ResolvedButton resolveButton(const Slot &slot) const;
+
+    /// @brief Load all config layers, from the snapshot if it's up-to-date.
+    /// Otherwise the layers are parsed concurrently.
+    /// @param generatedJournal Replayed onto the generated config
+    /// @return The layers. Precedence: generated > user > default
+    static QVector<QSharedPointer<Config>> loadConfigs(
+        const QString &userConfigPath, const QString &generatedConfigPath,
+        const ConfigJournal &generatedJournal, const QString &cachePath);
+
+    /// @brief Updates of the generated config not yet saved
+    QVector<ConfigJournal::Entry> unsavedEntries;
+
     /// @brief A list of configs to stack
     QVector<QSharedPointer<Config>> configs;
 
-    /// @{
-    /// @brief Reference to #configs. Precedence: generated > user > default
-    Config &generatedConfig;
-    Config &userConfig;
-    Config &defaultConfig;
-    /// @}
+    /// @brief The effective buttons of all defined slots
+    /// @details A standard button in any layer takes precedence over custom
+    /// buttons, then upper layers take precedence over lower ones.
+    SlotMap<ResolvedButton> resolvedButtons;
+
+    /// @brief Svg defs stacked from all layers
+    QHash<QString, QString> mergedSvgDefs;
+    /// @brief #mergedSvgDefs with references resolved
+    SvgDefGraph svgDefGraph;
+
+    /// @brief Indices of #configs. Precedence: generated > user > default
+    enum Layer { Generated = 0, User, Default };
 
+    const QString userConfigPath;
     const QString generatedConfigPath;
+
+    /// @brief Writes the generated config and its journal
+    ConfigWriter *generatedWriter = nullptr;
+
+    /// @brief Watches #userConfigPath and its directory
+    QFileSystemWatcher *userConfigWatcher = nullptr;
+    /// @brief Coalesces bursts of file change notifications into one reload
+    QTimer *reloadTimer = nullptr;
 };
 
 #endif // CONFIGS_HPP
@@ -0,0 +1,74 @@
+#include "configwriter.hpp"
+
+#include "constants.hpp"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDebug>
+
+ConfigWriter::ConfigWriter(
+    const QSharedPointer<ConfigJournal> &journal, const Config &config,
+    QObject *parent)
+    : QObject(parent), journal(journal), config(config),
+      journalSize(journal->size()),
+      compactionDue(
+          journal->hasLeftover()
+          || journalSize >= C::configJournalMaxEntries) {
+    writerThread.setMaxThreadCount(1);
+    // Don't keep an idle thread around, saves are rare
+    writerThread.setExpiryTimeout(C::configWriteDelayMs);
+
+    writeTimer.setSingleShot(true);
+    writeTimer.setInterval(C::configWriteDelayMs);
+    connect(&writeTimer, &QTimer::timeout, this, &ConfigWriter::write);
+
+    // Finish the compaction left by the last run, or fold a long journal.
+    // The timer may not run yet, since there can be no event loop so far.
+    if (compactionDue)
+        write();
+}
+
+void ConfigWriter::save(const QVector<ConfigJournal::Entry> &entries) {
+    queuedEntries += entries;
+    journalSize += entries.size();
+    if (journalSize >= C::configJournalMaxEntries)
+        compactionDue = true;
+    writeTimer.start();
+}
+
+void ConfigWriter::flush() {
+    write();
+    writerThread.waitForDone();
+}
+
+void ConfigWriter::write() {
+    writeTimer.stop();
+    if (queuedEntries.isEmpty() && !compactionDue)
+        return;
+
+    // The config keeps changing on this thread, copy it now
+    QByteArray snapshot;
+    if (compactionDue) {
+        QDataStream out(&snapshot, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << config;
+        compactionDue = false;
+        journalSize = 0;
+    }
+
+    writerThread.start(
+        [journal = journal, entries = std::move(queuedEntries), snapshot] {
+            // The snapshot includes the entries, record them anyway in case
+            // the compaction fails
+            journal->append(entries);
+            if (snapshot.isEmpty())
+                return;
+
+            QDataStream in(snapshot);
+            in.setVersion(QDataStream::Qt_5_12);
+            Config config(in);
+            if (in.status() != QDataStream::Ok || !journal->compact(config))
+                qWarning("Config compaction failed, will retry next start.");
+        });
+    queuedEntries.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef CONFIGWRITER_HPP
+#define CONFIGWRITER_HPP
+
+#include "config.hpp"
+#include "configjournal.hpp"
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+/// @brief Writes changes of a config to disk on a background thread.
+/// @details Saves are queued and coalesced for a short while, then recorded
+/// to the journal on a dedicated thread. When the journal grows long, a
+/// snapshot of the config is taken on the calling thread and folded into the
+/// config file on the same background thread, which writes to a temporary
+/// file and renames it over the original. The calling thread never waits for
+/// disk I/O, except in flush().
+class ConfigWriter : public QObject {
+    Q_OBJECT
+public:
+    /// @param journal The journal of the config. It's only accessed from the
+    /// writer thread from now on.
+    /// @param config The config to write, which must outlive this writer.
+    explicit ConfigWriter(
+        const QSharedPointer<ConfigJournal> &journal, const Config &config,
+        QObject *parent = nullptr);
+
+    /// @brief Queue entries to record
+    /// @details The entries must have been applied to #config already.
+    void save(const QVector<ConfigJournal::Entry> &entries);
+
+public slots:
+    /// @brief Write all queued entries and wait until everything is on disk
+    void flush();
+
+private:
+    /// @brief Hand queued entries, and a snapshot if due, to the writer thread
+    void write();
+
+    /// @brief Runs the writes, one at a time and in order
+    QThreadPool writerThread;
+    /// @brief Coalesces bursts of saves
+    QTimer writeTimer;
+
+    /// @brief Only accessed from #writerThread
+    QSharedPointer<ConfigJournal> journal;
+    const Config &config;
+
+    /// @brief Entries not yet handed to #writerThread
+    QVector<ConfigJournal::Entry> queuedEntries;
+    /// @brief Number of entries in the journal once handed writes are done
+    qsizetype journalSize;
+    /// @brief Whether to fold the journal with the next write
+    bool compactionDue;
+};
+
+#endif // CONFIGWRITER_HPP
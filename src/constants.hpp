@@ -23,8 +23,37 @@ consteval qreal RAD(qreal deg) noexcept {
     return deg * M_PI / 180;
 }
 
-/// @brief Number of icons to cache
-constexpr size_t iconCacheSize = 1000;
+/// @brief Rendered icons persisted across runs, stored under the cache dir
+cccp iconDiskCacheDir = "icons";
+/// @brief Bump this whenever the icon file layout or the rendering changes
+constexpr quint32 iconDiskCacheVersion = 1;
+/// @brief Prune the oldest rendered icons beyond this size
+constexpr qint64 iconDiskCacheMaxBytes = 64 << 20;
+/// @brief Prune the rendered icons again whenever this much was written
+constexpr qint64 iconDiskCachePruneBytes = 8 << 20;
+
+/// @brief List of system font files, stored under the cache dir
+cccp fontIndexFile = "fonts.index";
+/// @brief Bump this whenever the font index layout, or what gets indexed,
+/// changes
+constexpr quint32 fontIndexVersion = 2;
+
+/// @brief Binary snapshot of the parsed configs, stored under the cache dir
+cccp configCacheFile = "config.snapshot";
+/// @brief Bump this whenever the snapshot layout or the parsing logic changes
+constexpr quint32 configCacheVersion = 6;
+
+/// @brief How long to wait for the user config to settle before reloading it
+constexpr int configReloadDelayMs = 200;
+
+/// @brief Journal of changes to the generated config, stored next to it
+cccp configJournalSuffix = ".journal";
+/// @brief A journal being folded into the generated config
+cccp configCompactingSuffix = ".journal.compacting";
+/// @brief Fold the journal into the generated config beyond this many entries
+constexpr qsizetype configJournalMaxEntries = 64;
+/// @brief How long to coalesce saves of the generated config before writing
+constexpr int configWriteDelayMs = 500;
 
 /// @brief MIME type to be used by the clipboard
 cccp styleMimeType = "image/x-inkscape-svg";
@@ -40,6 +69,21 @@ namespace IconDrawing {
 } // namespace IconDrawing
 namespace IC = IconDrawing;
 
+/// @brief Panel layout constants
+namespace PanelGeometry {
+    /// @brief How much should the buttons scale on mouse hover
+    constexpr qreal hoverScale = 1.5;
+    /// @brief Radius of the main hexagon (edge length)
+    constexpr qreal unitLen = 200;
+    /// @brief Gap between buttons
+    constexpr qreal gapLen = 3;
+} // namespace PanelGeometry
+namespace PG = PanelGeometry;
+
+/// @brief Number of icons to prepare per event loop iteration while warming
+/// up icons
+constexpr int warmUpBatchSize = 16;
+
 /// @brief Default button colors when no config file is provided
 namespace DefaultButtonColors {
     static constexpr QColor off(0x20, 0x20, 0x20, 0x80);
@@ -67,6 +111,10 @@ namespace Configs {
             cccp texEditorCmd = "tex-editor-cmd";
             cccp texCompileCmd = "tex-compile-cmd";
             cccp pdfToSvgCmd = "pdf-to-svg-cmd";
+            cccp watchConfig = "watch-config";
+            cccp warmUpThreads = "warm-up-threads";
+            cccp warmUpBudgetMs = "warm-up-budget-ms";
+            cccp iconCacheMb = "icon-cache-mb";
         } // namespace Keys
         namespace K = Keys;
         namespace Values {
@@ -123,6 +171,16 @@ namespace Configs {
         namespace K = Keys;
     } // namespace SvgDefs
     namespace SD = SvgDefs;
+    /// @brief Entries of the generated config journal
+    namespace Journal {
+        namespace Keys {
+            cccp slot = "slot";
+            cccp styles = "styles";
+            cccp svgDefs = "svg-defs";
+        } // namespace Keys
+        namespace K = Keys;
+    } // namespace Journal
+    namespace J = Journal;
 } // namespace Configs
 namespace C = Configs;
 
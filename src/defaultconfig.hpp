@@ -0,0 +1,44 @@
+#ifndef DEFAULTCONFIG_HPP
+#define DEFAULTCONFIG_HPP
+
+#include <QtGlobal>
+#include <array>
+#include <cstddef>
+
+/// @brief The default config, compiled from res/default.yaml at build time.
+/// @details The tables are generated into `defaultconfigdata.hpp` by
+/// tools/gendefaultconfig.cpp. All strings are UTF-8 encoded. Include the
+/// generated header to use them.
+namespace DefaultConfig {
+
+/// @brief A style entry of a standard button
+struct Style {
+    /// @brief Index in #C::C::B::K::basicStyles, i.e. a StyleRecord::Key
+    quint8 key;
+    const char *value;
+};
+
+/// @brief A button entry
+struct Button {
+    quint32 slot;
+    /// @brief The custom icon, or nullptr if not specified
+    const char *icon;
+    /// @brief The custom style svg, or nullptr if this is a standard button
+    const char *svg;
+    /// @brief Styles in range [firstStyle, firstStyle + numStyles) of #styles
+    size_t firstStyle;
+    size_t numStyles;
+    /// @brief Ids in range [firstDefId, firstDefId + numDefIds) of #defIds
+    size_t firstDefId;
+    size_t numDefIds;
+};
+
+/// @brief A composed svg def, e.g. `<pattern id="..." ...>...</pattern>`
+struct SvgDef {
+    const char *id;
+    const char *svg;
+};
+
+} // namespace DefaultConfig
+
+#endif // DEFAULTCONFIG_HPP
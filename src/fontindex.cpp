@@ -0,0 +1,157 @@
+#include "fontindex.hpp"
+
+#include "constants.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+/// @brief Magic number at the head of the index file ("ISFI")
+static constexpr quint32 indexMagic = 0x49534649;
+
+QDataStream &operator<<(QDataStream &out, const FontIndex::Dir &dir) {
+    return out << dir.path << dir.mtime;
+}
+
+QDataStream &operator>>(QDataStream &in, FontIndex::Dir &dir) {
+    return in >> dir.path >> dir.mtime;
+}
+
+/// @brief Modification time of a directory, or -1 if it doesn't exist
+static qint64 _dirMtime(const QString &path) {
+    QFileInfo info(path);
+    return info.isDir() ? info.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+FontIndex::FontIndex(const QString &cachePath)
+    : indexPath(
+        cachePath.isEmpty() ? QString() : cachePath + "/" + C::fontIndexFile) {
+}
+
+QStringList FontIndex::fontDirs() {
+    // Where resvg's font database looks, and where Qt does
+    QStringList dirs =
+        QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
+#if defined(Q_OS_WIN)
+    dirs << qEnvironmentVariable("SystemRoot", "C:/Windows") + "/Fonts";
+#elif defined(Q_OS_MACOS)
+    dirs << "/Library/Fonts" << "/System/Library/Fonts"
+         << QDir::homePath() + "/Library/Fonts";
+#else
+    dirs << "/usr/share/fonts" << "/usr/local/share/fonts"
+         << QDir::homePath() + "/.fonts"
+         << QStandardPaths::writableLocation(
+                QStandardPaths::GenericDataLocation)
+                + "/fonts";
+#endif
+
+    // Drop duplicates and directories inside others
+    for (QString &dir : dirs)
+        dir = QDir::cleanPath(dir);
+    dirs.removeDuplicates();
+    dirs.sort();
+    QStringList result;
+    for (const QString &dir : dirs)
+        if (result.isEmpty() || !dir.startsWith(result.last() + "/"))
+            result.append(dir);
+    return result;
+}
+
+void FontIndex::scan(
+    const QString &path, QVector<Dir> &dirs, QStringList &fonts,
+    QSet<QString> &visited) {
+    // Links are followed, so a directory may be reached again, even from
+    // inside itself
+    QString canonicalPath = QFileInfo(path).canonicalFilePath();
+    if (!canonicalPath.isEmpty() && visited.contains(canonicalPath))
+        return;
+    visited.insert(canonicalPath);
+    dirs.append({path, _dirMtime(path)});
+    if (dirs.last().mtime < 0)
+        return;
+
+    static const QStringList filters{"*.ttf", "*.otf", "*.ttc", "*.otc"};
+    QDir dir(path);
+    dir.setNameFilters(filters);
+    for (const QString &font :
+         dir.entryList(QDir::Files | QDir::Readable, QDir::Name))
+        fonts.append(dir.filePath(font));
+
+    for (const QString &subdir :
+         dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        scan(dir.filePath(subdir), dirs, fonts, visited);
+}
+
+QStringList FontIndex::files() const {
+    QStringList fonts;
+    if (load(fonts))
+        return fonts;
+
+    QVector<Dir> dirs;
+    QSet<QString> visited;
+    for (const QString &path : fontDirs())
+        scan(path, dirs, fonts, visited);
+    qDebug(
+        "Font index rebuilt: %lld fonts in %lld directories",
+        qlonglong(fonts.size()), qlonglong(dirs.size()));
+    save(dirs, fonts);
+    return fonts;
+}
+
+bool FontIndex::load(QStringList &fonts) const {
+    if (indexPath.isEmpty())
+        return false;
+
+    QFile file(indexPath);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version;
+    QStringList roots;
+    QVector<Dir> dirs;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != indexMagic
+        || version != C::fontIndexVersion)
+        return false;
+    in >> roots >> dirs >> fonts;
+    if (in.status() != QDataStream::Ok || roots != fontDirs()) {
+        fonts.clear();
+        return false;
+    }
+
+    // Adding, removing or renaming anything changes the time of its parent
+    for (const Dir &dir : dirs)
+        if (_dirMtime(dir.path) != dir.mtime) {
+            qDebug(
+                "Font directory %s changed, rescanning fonts",
+                dir.path.toStdString().c_str());
+            fonts.clear();
+            return false;
+        }
+    return true;
+}
+
+void FontIndex::save(
+    const QVector<Dir> &dirs, const QStringList &fonts) const {
+    if (indexPath.isEmpty())
+        return;
+
+    QSaveFile file(indexPath);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning(
+            "Cannot write font index %s.", indexPath.toStdString().c_str());
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << indexMagic << C::fontIndexVersion << fontDirs() << dirs << fonts;
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qWarning(
+            "Cannot write font index %s.", indexPath.toStdString().c_str());
+}
@@ -0,0 +1,54 @@
+#ifndef FONTINDEX_HPP
+#define FONTINDEX_HPP
+
+#include <QDataStream>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// @brief The system font files, remembered across runs.
+/// @details Finding fonts means walking every font directory recursively. The
+/// files found are stored in the cache dir along with the modification time of
+/// every directory walked. Since adding or removing a file changes the time of
+/// its directory, later runs only need to check those times to reuse the list.
+class FontIndex {
+public:
+    /// @param cachePath The directory to store the index in. The index is not
+    /// persisted if this is empty.
+    explicit FontIndex(const QString &cachePath);
+
+    /// @brief Get the font files, walking the font directories if the stored
+    /// index is missing or outdated
+    QStringList files() const;
+
+    /// @brief Directories to look for fonts in
+    static QStringList fontDirs();
+
+private:
+    /// @brief A directory and its modification time when walked
+    struct Dir {
+        QString path;
+        qint64 mtime;
+    };
+    friend QDataStream &operator<<(QDataStream &out, const Dir &dir);
+    friend QDataStream &operator>>(QDataStream &in, Dir &dir);
+
+    /// @brief Walk @p path recursively, collecting directories and fonts
+    /// @details Links to directories are followed.
+    /// @param visited Canonical paths of the directories walked, so that each
+    /// is walked once, even if links form loops
+    static void scan(
+        const QString &path, QVector<Dir> &dirs, QStringList &fonts,
+        QSet<QString> &visited);
+
+    /// @brief Load the stored index
+    /// @return Whether it exists and is up-to-date
+    bool load(QStringList &fonts) const;
+
+    void save(const QVector<Dir> &dirs, const QStringList &fonts) const;
+
+    const QString indexPath;
+};
+
+#endif // FONTINDEX_HPP
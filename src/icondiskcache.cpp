@@ -0,0 +1,135 @@
+#include "icondiskcache.hpp"
+
+#include "constants.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+#include <memory>
+
+/// @brief Magic number at the head of icon files ("ISIC")
+static constexpr quint32 iconMagic = 0x49534943;
+
+/// @brief Head of icon files, followed by the pixels. Padded to keep the
+/// pixels aligned.
+struct IconHeader {
+    quint32 magic;
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    quint32 reserved[3];
+};
+static_assert(sizeof(IconHeader) == 32);
+
+IconDiskCache::IconDiskCache(const QString &cachePath)
+    : dirPath(cachePath + "/" + C::iconDiskCacheDir) {
+    if (!QDir().mkpath(dirPath))
+        qWarning("Cannot create icon cache %s.", dirPath.toStdString().c_str());
+    prune();
+}
+
+QByteArray IconDiskCache::genKey(
+    const QByteArray &svg, const QSize &size, const QByteArray &options) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(C::iconDiskCacheVersion) + ';');
+    hash.addData(options + ';');
+    hash.addData(
+        QByteArray::number(size.width()) + 'x'
+        + QByteArray::number(size.height()) + ';');
+    hash.addData(svg);
+    return hash.result().toHex();
+}
+
+QString IconDiskCache::filePath(const QByteArray &key) const {
+    return dirPath + "/" + QString::fromLatin1(key);
+}
+
+QImage IconDiskCache::load(const QByteArray &key) const {
+    auto file = std::make_unique<QFile>(filePath(key));
+    if (!file->open(QFile::ReadOnly)
+        || file->size() < qint64(sizeof(IconHeader)))
+        return {};
+
+    const uchar *data = file->map(0, file->size());
+    if (!data)
+        return {};
+
+    IconHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != iconMagic || header.version != C::iconDiskCacheVersion
+        || header.width <= 0 || header.height <= 0
+        || header.bytesPerLine < header.width * 4
+        || qint64(sizeof(header)) + qint64(header.bytesPerLine) * header.height
+               != file->size()) {
+        qWarning(
+            "Dropping corrupted cached icon %s.",
+            file->fileName().toStdString().c_str());
+        file->unmap(const_cast<uchar *>(data));
+        file->remove();
+        return {};
+    }
+
+    // The image refers to the mapping, which lives as long as the file
+    QFile *mapped = file.release();
+    return QImage(
+        data + sizeof(header), header.width, header.height,
+        header.bytesPerLine, QImage::Format_ARGB32_Premultiplied,
+        [](void *file) { delete static_cast<QFile *>(file); }, mapped);
+}
+
+void IconDiskCache::save(const QByteArray &key, const QImage &icon) const {
+    QImage image = icon.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    IconHeader header{
+        iconMagic,
+        C::iconDiskCacheVersion,
+        image.width(),
+        image.height(),
+        image.bytesPerLine(),
+        {}};
+
+    QSaveFile file(filePath(key));
+    qint64 size = image.sizeInBytes();
+    if (!file.open(QFile::WriteOnly)
+        || file.write(reinterpret_cast<const char *>(&header), sizeof(header))
+               != qint64(sizeof(header))
+        || file.write(reinterpret_cast<const char *>(image.constBits()), size)
+               != size
+        || !file.commit()) {
+        qWarning(
+            "Cannot write cached icon %s.",
+            file.fileName().toStdString().c_str());
+        return;
+    }
+
+    // Only the thread crossing the mark prunes
+    qint64 saved = qint64(sizeof(header)) + size;
+    qint64 before = unprunedBytes.fetch_add(saved);
+    if (before < C::iconDiskCachePruneBytes
+        && before + saved >= C::iconDiskCachePruneBytes) {
+        unprunedBytes -= C::iconDiskCachePruneBytes;
+        prune();
+    }
+}
+
+void IconDiskCache::prune() const {
+    QFileInfoList files =
+        QDir(dirPath).entryInfoList(QDir::Files, QDir::Time);
+    qint64 totalSize = 0;
+    qsizetype numRemoved = 0;
+    // Newest first
+    for (const QFileInfo &info : files) {
+        totalSize += info.size();
+        if (totalSize > C::iconDiskCacheMaxBytes
+            && QFile::remove(info.filePath()))
+            ++numRemoved;
+    }
+    if (numRemoved)
+        qDebug(
+            "Pruned %lld icons from %s", qlonglong(numRemoved),
+            dirPath.toStdString().c_str());
+}
@@ -0,0 +1,51 @@
+#ifndef ICONDISKCACHE_HPP
+#define ICONDISKCACHE_HPP
+
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <atomic>
+
+/// @brief Rendered icons kept on disk across runs.
+/// @details Icons are content-addressed: each one is stored in its own file,
+/// named after a hash of everything the rendering depends on (see genKey()).
+/// Nothing is ever invalidated, a changed icon simply gets a new key. Files
+/// hold raw premultiplied ARGB32 pixels, which are memory-mapped and handed to
+/// QImage without decoding or copying. The least recently written files are
+/// pruned beyond C::iconDiskCacheMaxBytes on construction, and again each time
+/// another C::iconDiskCachePruneBytes have been saved.
+class IconDiskCache {
+public:
+    /// @param cachePath The directory to create the cache in
+    explicit IconDiskCache(const QString &cachePath);
+
+    /// @brief Identify a rendering
+    /// @param svg The svg to render
+    /// @param size The size to render at
+    /// @param options Identifies the renderer options
+    static QByteArray
+    genKey(const QByteArray &svg, const QSize &size, const QByteArray &options);
+
+    /// @brief Load a cached icon
+    /// @return The icon, which maps the cache file, or a null image if not
+    /// cached
+    QImage load(const QByteArray &key) const;
+
+    /// @brief Store an icon
+    /// @note Thread-safe
+    void save(const QByteArray &key, const QImage &icon) const;
+
+private:
+    /// @brief Drop the oldest files until within C::iconDiskCacheMaxBytes
+    void prune() const;
+
+    QString filePath(const QByteArray &key) const;
+
+    /// @brief Where the icon files are
+    const QString dirPath;
+    /// @brief Bytes saved since the last prune()
+    mutable std::atomic<qint64> unprunedBytes = 0;
+};
+
+#endif // ICONDISKCACHE_HPP
@@ -0,0 +1,63 @@
+#include "iconmemorycache.hpp"
+
+#include <QPair>
+#include <QtDebug>
+#include <algorithm>
+#include <limits>
+
+uint qHash(const IconKey &key, uint seed) {
+    return qHash(key.fingerprint, seed)
+           ^ qHash(QPair<int, int>(key.size.width(), key.size.height()), seed)
+           ^ (uint(key.kind) << 8 | key.variant);
+}
+
+IconMemoryCache::IconMemoryCache(qint64 budget) {
+    setBudget(budget);
+}
+
+QImage *IconMemoryCache::object(const IconKey &key) {
+    QImage *icon = cache.object(key);
+    ++(icon ? hits : misses);
+    return icon;
+}
+
+bool IconMemoryCache::contains(const IconKey &key) const {
+    return cache.contains(key);
+}
+
+void IconMemoryCache::insert(const IconKey &key, QImage *icon) {
+    // QCache doesn't tell what it evicts, count the icons gone instead
+    int expected = cache.count() + !cache.contains(key);
+    cache.insert(key, icon, cost(*icon));
+    evictions += quint64(expected - cache.count());
+}
+
+bool IconMemoryCache::hasRoom(const QImage &icon) const {
+    return cache.totalCost() + cost(icon) <= cache.maxCost();
+}
+
+void IconMemoryCache::setBudget(qint64 budget) {
+    int expected = cache.count();
+    cache.setMaxCost(int(std::clamp<qint64>(
+        budget >> 10, 0, std::numeric_limits<int>::max())));
+    evictions += quint64(expected - cache.count());
+}
+
+void IconMemoryCache::clear() {
+    cache.clear();
+}
+
+void IconMemoryCache::logStats(const char *when) const {
+    quint64 lookups = hits + misses;
+    qDebug(
+        "Icon cache %s: %d icons, %d of %d KiB, %llu hits, %llu misses "
+        "(%.1f%% hit rate), %llu evictions",
+        when, cache.count(), cache.totalCost(), cache.maxCost(),
+        qulonglong(hits), qulonglong(misses),
+        lookups ? 100. * double(hits) / double(lookups) : 0.,
+        qulonglong(evictions));
+}
+
+int IconMemoryCache::cost(const QImage &icon) {
+    return int(std::max<qsizetype>((icon.sizeInBytes() + 1023) >> 10, 1));
+}
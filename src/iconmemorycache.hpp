@@ -0,0 +1,74 @@
+#ifndef ICONMEMORYCACHE_HPP
+#define ICONMEMORYCACHE_HPP
+
+#include <QCache>
+#include <QImage>
+#include <QSize>
+
+/// @brief Identifies a rendered icon
+struct IconKey {
+    /// @brief What the icon is drawn for
+    enum Kind : quint8 { StyleButton, CentralButton, CentralLayer };
+
+    Kind kind;
+    /// @brief ButtonInfo::getFingerprint() of the styles shown
+    quint64 fingerprint;
+    /// @brief Size of the icon in device pixels
+    QSize size;
+    /// @brief Tells apart icons drawn differently for the same styles: the
+    /// orientation of style buttons, or the Indicator of central button layers
+    quint8 variant = 0;
+
+    bool operator==(const IconKey &other) const = default;
+};
+
+uint qHash(const IconKey &key, uint seed = 0);
+
+/// @brief Rendered icons kept in memory, within a budget in bytes.
+/// @details Icons of all kinds share one least recently used list, and each
+/// one is charged by the size of its pixels, so a large central button icon
+/// counts for as much as the many small triangles it could make room for.
+/// Hits, misses and evictions are counted, see logStats(). Only use it on the
+/// GUI thread.
+class IconMemoryCache {
+public:
+    /// @param budget See setBudget()
+    explicit IconMemoryCache(qint64 budget);
+
+    /// @brief Look up an icon, and mark it as most recently used
+    /// @return The icon, or nullptr if it's not cached
+    QImage *object(const IconKey &key);
+
+    /// @brief Whether an icon is cached, without counting a hit or a miss
+    bool contains(const IconKey &key) const;
+
+    /// @brief Cache an icon, evicting the least recently used ones if needed
+    /// @param icon The cache takes its ownership, and deletes it right away
+    /// if it's larger than the budget. See QCache document.
+    void insert(const IconKey &key, QImage *icon);
+
+    /// @brief Whether an icon fits in without evicting any other
+    bool hasRoom(const QImage &icon) const;
+
+    /// @brief Set the memory to keep icons in, evicting icons beyond it
+    /// @param budget In bytes
+    void setBudget(qint64 budget);
+
+    void clear();
+
+    /// @brief Print the usage and the counters to the debug output
+    /// @param when What just happened, for the reader of the log
+    void logStats(const char *when) const;
+
+private:
+    /// @brief What an icon is charged, in KiB so that budgets beyond 2 GiB
+    /// fit in the int costs of QCache
+    static int cost(const QImage &icon);
+
+    QCache<IconKey, QImage> cache;
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+};
+
+#endif // ICONMEMORYCACHE_HPP
@@ -0,0 +1,492 @@
+#include "indicatorpainter.hpp"
+
+#include "constants.hpp"
+
+#include <QFontMetricsF>
+#include <QPen>
+#include <QtMath>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+using CBK = StyleRecord;
+namespace DIS = C::C::G::V::DIS;
+
+static constexpr quint16 _genMask(std::initializer_list<CBK::Key> keys) {
+    quint16 mask = 0;
+    for (CBK::Key key : keys)
+        mask |= 1u << key;
+    return mask;
+}
+
+/// @brief Triggers and styles of each indicator, see indicatorTriggers() and
+/// indicatorStyles()
+static constexpr std::pair<quint16, quint16> _indicatorMasks[] = {
+    {_genMask({CBK::fill, CBK::stroke, CBK::strokeDashArray}),
+     _genMask(
+         {CBK::fill, CBK::stroke, CBK::strokeDashArray,
+          CBK::strokeDashOffset})},
+    {_genMask({CBK::fillOpacity, CBK::strokeOpacity}),
+     _genMask(
+         {CBK::fill, CBK::stroke, CBK::fillOpacity, CBK::strokeOpacity})},
+    {_genMask({CBK::strokeWidth}), _genMask({CBK::strokeWidth})},
+    {_genMask({CBK::strokeLineCap}), _genMask({CBK::strokeLineCap})},
+    {_genMask({CBK::strokeLineJoin}), _genMask({CBK::strokeLineJoin})},
+    {_genMask({CBK::markerStart, CBK::markerMid, CBK::markerEnd}),
+     _genMask({CBK::markerStart, CBK::markerMid, CBK::markerEnd})},
+    {_genMask({CBK::fontFamily, CBK::fontStyle}),
+     _genMask({CBK::fontFamily, CBK::fontStyle})},
+    {_genMask({CBK::fontSize}), _genMask({CBK::fontSize})},
+};
+static_assert(std::size(_indicatorMasks) == numIndicators);
+
+quint16 indicatorTriggers(Indicator indicator) {
+    return _indicatorMasks[int(indicator)].first;
+}
+
+quint16 indicatorStyles(Indicator indicator) {
+    return _indicatorMasks[int(indicator)].second;
+}
+
+IndicatorAnchors genStyleButtonAnchors(
+    const QSizeF &iconSize, const QPointF &centroid, const Configs &configs,
+    bool orientation) {
+    using C::R30, C::R60, C::R45, C::RAD;
+
+    IndicatorAnchors a;
+    QSizeF size = a.size = iconSize;
+    a.questionBaseline = a.fontBaseline =
+        size.height() * (orientation ? 0.5 : 0.85);
+    a.fontSizeBaseline = size.height() * (orientation ? 0.4 : 0.75);
+
+    // button's centroid
+    QPointF c = a.c = centroid;
+    // color/gradient indicator's radius
+    qreal R = a.R = size.height() / 3. - C::IC::colorStrokeWidth / 2.;
+    // stroke-width
+    qreal sR = size.height() * 11. / 24.;
+    // marker indicator's radius
+    qreal mR = size.height() / 3.;
+
+    qreal invert = orientation ? -1 : 1;
+    // qreal mR = size.height() * 3. / 8.;
+    if (configs.defaultIconStyle == DIS::circle) {
+        a.tr = c + QPointF(R * qCos(R60), -R * qSin(R60));
+        a.bl = c + QPointF(-R * qCos(R60), R * qSin(R60));
+    } else if (configs.defaultIconStyle == DIS::square) {
+        a.tr = c + QPointF(R * qCos(R45), -R * qSin(R45));
+        a.bl = c + QPointF(-R * qCos(R45), R * qSin(R45));
+        sR *= 2. / qSqrt(3.);
+    }
+    a.sR = sR;
+    // stroke-width indicator's anchor points
+    a.str = c + QPointF(sR * qCos(R60), -sR * qSin(R60)) * invert;
+    a.stl = c + QPointF(-sR * qCos(R60), -sR * qSin(R60)) * invert;
+    // marker indicator's anchor points
+    a.mbl = c + QPointF(-mR * qCos(R45), mR * qSin(R45) * invert);
+    a.mbr = c + QPointF(mR * qCos(R45), mR * qSin(R45) * invert);
+    // line-cap indicator's anchor points
+    a.cb =
+        c + QPointF(-mR * qSin(R45) / qTan(RAD(40)), mR * qSin(R45) * invert);
+    a.cm =
+        c + QPointF(-mR * qSin(R45) / qTan(RAD(30)), mR * qSin(R45) * invert);
+    a.ce = a.cm
+           + (a.cb - a.cm).x() * QPointF(qCos(R60), -qSin(R60) * invert);
+    // line-join indicator's anchor points
+    a.jb =
+        c + QPointF(mR * qSin(R45) / qTan(RAD(40)), mR * qSin(R45) * invert);
+    a.jm =
+        c + QPointF(mR * qSin(R45) / qTan(RAD(30)), mR * qSin(R45) * invert);
+    a.je = a.jm + (a.jb - a.jm).x() * QPointF(qCos(R60), qSin(R60) * invert);
+    return a;
+}
+
+/// @brief Direction of @p point seen from @p center, in degrees
+/// counterclockwise as QPainterPath::arcTo() takes it
+static qreal _angle(const QPointF &center, const QPointF &point) {
+    return qRadiansToDegrees(
+        qAtan2(center.y() - point.y(), point.x() - center.x()));
+}
+
+/// @brief Like svg's `M from A r r 0 0 0 to`, for points on the circle
+static QPainterPath _genArc(
+    const QPointF &center, qreal radius, const QPointF &from,
+    const QPointF &to) {
+    qreal start = _angle(center, from);
+    qreal sweep = std::fmod(_angle(center, to) - start + 720., 360.);
+    QPainterPath path(from);
+    path.arcTo(
+        QRectF(center - QPointF(radius, radius), QSizeF(2, 2) * radius),
+        start, sweep);
+    return path;
+}
+
+/// @brief The pattern of _genCheckerboardSvg() in panel.cpp
+static QBrush _genCheckerboard() {
+    int w = int(C::IC::checkerboardWidth);
+    QImage tile(2 * w, 2 * w, QImage::Format_RGB32);
+    tile.fill(QColor(0x77, 0x77, 0x77));
+    QPainter painter(&tile);
+    painter.fillRect(0, w, w, w, Qt::white);
+    painter.fillRect(w, 0, w, w, Qt::white);
+    return QBrush(tile);
+}
+
+static bool _parseLength(const QString &value, qreal &length) {
+    QString number = value.trimmed();
+    if (number.endsWith(QLatin1String("px")))
+        number.chop(2);
+    bool ok;
+    length = number.toDouble(&ok);
+    return ok && length >= 0;
+}
+
+static bool _parseOpacity(const QString &value, qreal &opacity) {
+    QString number = value.trimmed();
+    qreal scale = 1;
+    if (number.endsWith('%')) {
+        number.chop(1);
+        scale = 0.01;
+    }
+    bool ok;
+    opacity = qBound(0., number.toDouble(&ok) * scale, 1.);
+    return ok;
+}
+
+static bool _parsePaint(const QString &value, QBrush &brush) {
+    QString paint = value.trimmed();
+    if (paint == "none") {
+        brush = Qt::NoBrush;
+        return true;
+    }
+    // Qt reads #rgba and #rrggbbaa as argb. Leave url(), rgb() and such to
+    // resvg as well.
+    if ((paint.startsWith('#') && paint.size() != 4 && paint.size() != 7)
+        || !QColor::isValidColor(paint))
+        return false;
+    brush = QColor(paint);
+    return true;
+}
+
+static bool _parseDashes(const QString &value, QVector<qreal> &dashes) {
+    dashes.clear();
+    if (value.trimmed() == "none")
+        return true;
+
+    bool nonZero = false;
+    for (const QString &dash : QString(value).replace(',', ' ').split(' ')) {
+        if (dash.isEmpty())
+            continue;
+        qreal length;
+        if (!_parseLength(dash, length))
+            return false;
+        dashes.append(length);
+        nonZero |= length > 0;
+    }
+    // Odd lists are repeated, and all-zero lists mean solid lines
+    if (dashes.size() % 2)
+        dashes += dashes;
+    if (!nonZero)
+        dashes.clear();
+    return true;
+}
+
+bool IndicatorPainter::Shape::set(CBK::Key key, const QString &value) {
+    switch (key) {
+    case CBK::fill:
+        return _parsePaint(value, fill);
+    case CBK::stroke:
+        return _parsePaint(value, stroke);
+    case CBK::fillOpacity:
+        return _parseOpacity(value, fillOpacity);
+    case CBK::strokeOpacity:
+        return _parseOpacity(value, strokeOpacity);
+    case CBK::strokeWidth:
+        return _parseLength(value, strokeWidth);
+    case CBK::strokeDashArray:
+        return _parseDashes(value, dashes);
+    case CBK::strokeDashOffset: {
+        bool ok;
+        dashOffset = value.trimmed().toDouble(&ok);
+        return ok;
+    }
+    case CBK::strokeLineCap: {
+        static const QHash<QString, Qt::PenCapStyle> caps{
+            {"butt", Qt::FlatCap},
+            {"round", Qt::RoundCap},
+            {"square", Qt::SquareCap}};
+        cap = caps.value(value.trimmed(), Qt::MPenCapStyle);
+        return cap != Qt::MPenCapStyle;
+    }
+    case CBK::strokeLineJoin: {
+        static const QHash<QString, Qt::PenJoinStyle> joins{
+            {"miter", Qt::MiterJoin},
+            {"round", Qt::RoundJoin},
+            {"bevel", Qt::BevelJoin}};
+        join = joins.value(value.trimmed(), Qt::MPenJoinStyle);
+        return join != Qt::MPenJoinStyle;
+    }
+    default:
+        return false;
+    }
+}
+
+IndicatorPainter::IndicatorPainter(
+    QImage &image, const IndicatorAnchors &anchors, const Configs &configs,
+    const StandardButtonInfo &info)
+    : painter(&image), a(anchors), configs(configs), info(info) {
+    painter.setRenderHints(
+        QPainter::Antialiasing | QPainter::TextAntialiasing
+        | QPainter::SmoothPixmapTransform);
+    // The same scaling as resvg does for the viewBox
+    painter.scale(
+        image.width() / anchors.size.width(),
+        image.height() / anchors.size.height());
+}
+
+QImage IndicatorPainter::paint(
+    const IndicatorAnchors &anchors, const QSize &size, const Configs &configs,
+    const StandardButtonInfo &info, Indicators indicators) {
+    auto shows = [&](Indicator indicator) -> bool {
+        return (indicators & (1u << int(indicator)))
+               && showsIndicator(info.styles(), indicator);
+    };
+
+    // Markers always refer to defs
+    if (!info.getDefIds().isEmpty() || !info.getDisplayDefsSvg().isEmpty()
+        || shows(Indicator::Marker))
+        return QImage();
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull())
+        return QImage();
+    image.fill(Qt::transparent);
+
+    // In the same order as the svg
+    IndicatorPainter p(image, anchors, configs, info);
+    bool painted =
+        (!info.isEmpty()
+         || p.drawText(
+             "?", anchors.size.width() * 0.5, anchors.questionBaseline, true,
+             anchors.size.height() * 0.5))
+        && (!shows(Indicator::Color) || p.paintColor())
+        && (!shows(Indicator::Opacity) || p.paintOpacity())
+        && (!shows(Indicator::StrokeWidth) || p.paintStrokeWidth())
+        && (!shows(Indicator::StrokeCap) || p.paintStrokeCap())
+        && (!shows(Indicator::StrokeJoin) || p.paintStrokeJoin())
+        && (!shows(Indicator::Font) || p.paintFont())
+        && (!shows(Indicator::FontSize) || p.paintFontSize());
+    p.painter.end();
+    return painted ? image : QImage();
+}
+
+bool IndicatorPainter::apply(Shape &shape, CBK::Key key) const {
+    return !has(key) || shape.set(key, info.styles()[key]);
+}
+
+void IndicatorPainter::draw(QPainterPath path, const Shape &shape) {
+    // Fill first, then stroke, as svg does
+    path.setFillRule(Qt::WindingFill);
+    if (shape.fill.style() != Qt::NoBrush && shape.fillOpacity > 0) {
+        painter.setOpacity(shape.fillOpacity);
+        painter.fillPath(path, shape.fill);
+    }
+
+    if (shape.stroke.style() != Qt::NoBrush && shape.strokeWidth > 0
+        && shape.strokeOpacity > 0) {
+        QPen pen(
+            shape.stroke, shape.strokeWidth, Qt::SolidLine, shape.cap,
+            shape.join);
+        // Qt measures dashes in stroke widths
+        if (!shape.dashes.isEmpty()) {
+            QVector<qreal> pattern;
+            for (qreal dash : shape.dashes)
+                pattern.append(dash / shape.strokeWidth);
+            pen.setDashPattern(pattern);
+            pen.setDashOffset(shape.dashOffset / shape.strokeWidth);
+        }
+        painter.setOpacity(shape.strokeOpacity);
+        painter.strokePath(path, pen);
+    }
+    painter.setOpacity(1);
+}
+
+bool IndicatorPainter::drawText(
+    const QString &text, qreal x, qreal baseline, bool anchorMiddle,
+    qreal fontSize, const QString &families, const QString &fontStyle) {
+    // Leave entities and markup to resvg
+    if (text.contains('&') || text.contains('<'))
+        return false;
+
+    // resvg falls back to Times New Roman
+    QFont font("Times New Roman");
+    font.setStyleHint(QFont::Serif);
+    if (!families.isEmpty()) {
+        // Qt takes one family, the generic ones become style hints
+        QString family = families.section(',', 0, 0).trimmed();
+        if (family.size() >= 2 && (family[0] == '\'' || family[0] == '"')
+            && family.back() == family[0])
+            family = family.mid(1, family.size() - 2);
+        static const QHash<QString, QFont::StyleHint> hints{
+            {"serif", QFont::Serif},
+            {"sans-serif", QFont::SansSerif},
+            {"monospace", QFont::Monospace},
+            {"cursive", QFont::Cursive},
+            {"fantasy", QFont::Fantasy}};
+        font.setFamily(family);
+        font.setStyleHint(hints.value(family, QFont::AnyStyle));
+    }
+    if (!fontStyle.isEmpty()) {
+        static const QHash<QString, QFont::Style> styles{
+            {"normal", QFont::StyleNormal},
+            {"italic", QFont::StyleItalic},
+            {"oblique", QFont::StyleOblique}};
+        auto style = styles.find(fontStyle.trimmed());
+        if (style == styles.end())
+            return false;
+        font.setStyle(*style);
+    }
+    font.setPixelSize(qMax(1, qRound(fontSize)));
+
+    if (anchorMiddle)
+        x -= QFontMetricsF(font).horizontalAdvance(text) / 2;
+    QPainterPath path;
+    path.addText(x, baseline, font, text);
+    painter.fillPath(path, Qt::white);
+    return true;
+}
+
+QPainterPath
+IndicatorPainter::colorPath(const QPointF &from, const QPointF &to) const {
+    QPainterPath path;
+    if (configs.defaultIconStyle == DIS::circle) {
+        path = _genArc(a.c, a.R, from, to);
+    } else if (configs.defaultIconStyle == DIS::square) {
+        path.moveTo(from);
+        path.lineTo(to.x(), from.y());
+        path.lineTo(to);
+    }
+    return path;
+}
+
+bool IndicatorPainter::paintColor() {
+    QPainterPath path = colorPath(a.tr, a.bl);
+    if (path.isEmpty())
+        return true;
+
+    Shape shape;
+    // Set some defaults
+    if (!has(CBK::fill))
+        shape.fill = Qt::NoBrush;
+    if (has(CBK::stroke)) {
+        shape.strokeWidth = C::IC::colorStrokeWidth;
+    } else if (has(CBK::strokeDashArray) || has(CBK::strokeDashOffset)) {
+        shape.stroke = Qt::white;
+        shape.strokeWidth = C::IC::otherStrokeWidth;
+    }
+
+    for (CBK::Key key :
+         {CBK::fill, CBK::stroke, CBK::strokeDashArray, CBK::strokeDashOffset})
+        if (!apply(shape, key))
+            return false;
+    draw(path, shape);
+    return true;
+}
+
+bool IndicatorPainter::paintOpacity() {
+    static const QBrush checkerboard = _genCheckerboard();
+
+    QPainterPath path = colorPath(a.bl, a.tr);
+    if (path.isEmpty())
+        return true;
+
+    Shape background, shape;
+    // Set some defaults
+    if (!has(CBK::fillOpacity)) {
+        shape.fillOpacity = 0;
+        background.fillOpacity = 0;
+    } else {
+        if (!has(CBK::fill))
+            shape.fill = Qt::white;
+        background.fill = checkerboard;
+    }
+
+    if (has(CBK::strokeOpacity)) {
+        if (!has(CBK::stroke))
+            shape.stroke = Qt::white;
+        shape.strokeWidth = C::IC::colorStrokeWidth;
+        background.strokeWidth = C::IC::colorStrokeWidth;
+        background.stroke = checkerboard;
+    }
+
+    for (CBK::Key key :
+         {CBK::fill, CBK::stroke, CBK::fillOpacity, CBK::strokeOpacity})
+        if (!apply(shape, key))
+            return false;
+    draw(path, background);
+    draw(path, shape);
+    return true;
+}
+
+bool IndicatorPainter::paintStrokeWidth() {
+    QPainterPath path;
+    if (configs.defaultIconStyle == DIS::circle) {
+        path = _genArc(a.c, a.sR, a.str, a.stl);
+    } else if (configs.defaultIconStyle == DIS::square) {
+        path.moveTo(a.str);
+        path.lineTo(a.stl.x(), a.str.y());
+    } else {
+        return true;
+    }
+
+    Shape shape;
+    shape.fillOpacity = 0;
+    shape.stroke = Qt::white;
+    if (!apply(shape, CBK::strokeWidth))
+        return false;
+    draw(path, shape);
+    return true;
+}
+
+bool IndicatorPainter::paintStrokeCap() {
+    QPainterPath path(a.cb);
+    path.lineTo(a.cm);
+    path.lineTo(a.ce);
+
+    Shape shape;
+    shape.fillOpacity = 0;
+    shape.stroke = Qt::white;
+    shape.strokeWidth = C::IC::colorStrokeWidth;
+    if (!apply(shape, CBK::strokeLineCap))
+        return false;
+    draw(path, shape);
+    return true;
+}
+
+bool IndicatorPainter::paintStrokeJoin() {
+    QPainterPath path(a.jb);
+    path.lineTo(a.jm);
+    path.lineTo(a.je);
+
+    Shape shape;
+    shape.fillOpacity = 0;
+    shape.stroke = Qt::white;
+    shape.strokeWidth = C::IC::colorStrokeWidth;
+    if (!apply(shape, CBK::strokeLineJoin))
+        return false;
+    draw(path, shape);
+    return true;
+}
+
+bool IndicatorPainter::paintFont() {
+    return drawText(
+        configs.defaultIconText, a.size.width() * 0.5, a.fontBaseline, true,
+        a.size.height() * 0.5, info.styles()[CBK::fontFamily],
+        info.styles()[CBK::fontStyle]);
+}
+
+bool IndicatorPainter::paintFontSize() {
+    return drawText(
+        info.styles()[CBK::fontSize], a.size.width() * 0.6,
+        a.fontSizeBaseline, false, a.size.height() * 0.15, "sans-serif");
+}
@@ -0,0 +1,155 @@
+#ifndef INDICATORPAINTER_HPP
+#define INDICATORPAINTER_HPP
+
+#include "buttoninfo.hpp"
+#include "configs.hpp"
+
+#include <QBrush>
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPointF>
+#include <QSizeF>
+#include <QVector>
+
+/// @brief The indicators the icon of a standard style is made of, in drawing
+/// order
+enum class Indicator : quint8 {
+    Color,
+    Opacity,
+    StrokeWidth,
+    StrokeCap,
+    StrokeJoin,
+    Marker,
+    Font,
+    FontSize,
+};
+constexpr int numIndicators = int(Indicator::FontSize) + 1;
+
+/// @brief A set of indicators, bit `1 << indicator` is set for each one
+typedef quint16 Indicators;
+constexpr Indicators allIndicators = (1u << numIndicators) - 1;
+
+/// @brief Styles an indicator shows up for
+/// @return Bits as in StyleRecord::mask()
+quint16 indicatorTriggers(Indicator indicator);
+
+/// @brief Styles an indicator is drawn from, including its triggers
+/// @return Bits as in StyleRecord::mask()
+quint16 indicatorStyles(Indicator indicator);
+
+/// @brief Whether an indicator shows up in the icon of some styles
+inline bool showsIndicator(const StyleRecord &styles, Indicator indicator) {
+    return styles.mask() & indicatorTriggers(indicator);
+}
+
+/// @brief Where the indicators of a standard style go in its icon
+struct IndicatorAnchors {
+    QSizeF size;
+    /// @brief Center of the color and stroke-width indicators
+    QPointF c;
+    /// @brief Radius of the color indicators
+    qreal R;
+    /// @brief Radius of the stroke-width indicator
+    qreal sR;
+    /// @brief Ends of the color indicators
+    QPointF tr, bl;
+    /// @brief Ends of the stroke-width indicator
+    QPointF str, stl;
+    /// @brief Ends of the marker indicator
+    QPointF mbl, mbr;
+    /// @brief Vertices of the line-cap and line-join indicators
+    QPointF cb, cm, ce, jb, jm, je;
+    /// @brief Baselines of the texts
+    qreal questionBaseline, fontBaseline, fontSizeBaseline;
+};
+
+/// @brief Where the indicators go in the icon of a style button
+/// @param iconSize Size of the icon, in user units
+/// @param centroid Centroid of the triangular button in the icon
+/// @param orientation True if the button points up
+IndicatorAnchors genStyleButtonAnchors(
+    const QSizeF &iconSize, const QPointF &centroid, const Configs &configs,
+    bool orientation);
+
+/// @brief Draws the icon of a standard style with QPainter.
+/// @details The icon looks like the svg generated for the style rendered by
+/// resvg, at a fraction of the cost. Only styles made of plain values are
+/// drawn: anything referring to svg defs (gradients, patterns, markers), or
+/// values QPainter cannot represent, is left to resvg.
+class IndicatorPainter {
+public:
+    /// @param size Size of the icon in pixels, the anchors are scaled to it
+    /// @param indicators Which of the indicators to draw
+    /// @return The icon, or a null image if resvg has to draw the style
+    static QImage paint(
+        const IndicatorAnchors &anchors, const QSize &size,
+        const Configs &configs, const StandardButtonInfo &info,
+        Indicators indicators = allIndicators);
+
+private:
+    IndicatorPainter(
+        QImage &image, const IndicatorAnchors &anchors,
+        const Configs &configs, const StandardButtonInfo &info);
+
+    /// @brief Presentation attributes of a shape, defaulting to svg's
+    struct Shape {
+        /// @brief Set a style of the button
+        /// @return Whether the value is understood
+        bool set(StyleRecord::Key key, const QString &value);
+
+        /// @brief No fill/stroke if Qt::NoBrush
+        QBrush fill = QBrush(Qt::black);
+        QBrush stroke = QBrush(Qt::NoBrush);
+        qreal fillOpacity = 1;
+        qreal strokeOpacity = 1;
+        qreal strokeWidth = 1;
+        Qt::PenCapStyle cap = Qt::FlatCap;
+        Qt::PenJoinStyle join = Qt::MiterJoin;
+        /// @brief In user units
+        QVector<qreal> dashes;
+        qreal dashOffset = 0;
+    };
+
+    /// @brief Set a style of the button to a shape, if the button has it
+    bool apply(Shape &shape, StyleRecord::Key key) const;
+
+    void draw(QPainterPath path, const Shape &shape);
+
+    /// @param anchorMiddle Whether @p x is the center of the text, otherwise
+    /// its start
+    /// @param families As in css, empty for the default font
+    bool drawText(
+        const QString &text, qreal x, qreal baseline, bool anchorMiddle,
+        qreal fontSize, const QString &families = {},
+        const QString &fontStyle = {});
+
+    /// @{
+    /// @brief Draw an indicator, see the svg counterparts in indicatorsvg.cpp
+    /// @return False if the style has values that cannot be drawn
+    bool paintColor();
+    bool paintOpacity();
+    bool paintStrokeWidth();
+    bool paintStrokeCap();
+    bool paintStrokeJoin();
+    bool paintFont();
+    bool paintFontSize();
+    /// @}
+
+    /// @brief Half of a circle around IndicatorAnchors::c, or of a square
+    /// if the icon style says so
+    /// @return An empty path for unknown icon styles
+    QPainterPath colorPath(const QPointF &from, const QPointF &to) const;
+
+    bool has(StyleRecord::Key key) const {
+        return info.styles().contains(key);
+    }
+
+    QPainter painter;
+    const IndicatorAnchors &a;
+    const Configs &configs;
+    const StandardButtonInfo &info;
+};
+
+#endif // INDICATORPAINTER_HPP
@@ -0,0 +1,329 @@
+#include "indicatorsvg.hpp"
+
+#include "constants.hpp"
+#include "svgwriter.hpp"
+
+#include <tuple>
+
+static void _genQuestionMarkSvg(
+    SvgWriter &svg, const QSizeF &size, qreal baselineHeight) {
+    svg.open("text")
+        .attr("x", size.width() * 0.5)
+        .attr("y", baselineHeight)
+        .attr("fill", "#fff")
+        .beginAttr("style")
+        .prop("font-size", size.height() * 0.5)
+        .prop("text-anchor", "middle")
+        .endAttr()
+        .content("?")
+        .close();
+}
+
+static void _genColorSvg(
+    SvgWriter &svg, const Configs &configs, const StandardButtonInfo &info,
+    const QPointF &bl, const QPointF &tr, qreal radius) {
+    namespace IC = C::IC;
+    using CBK = StyleRecord;
+    namespace DIS = C::C::G::V::DIS;
+    auto has = [&](CBK::Key k) -> bool { return info.styles().contains(k); };
+
+    // Set geometry for the svg element
+    if (configs.defaultIconStyle == DIS::circle)
+        svg.open("path").beginAttr("d") << "M " << tr << " A " << radius << ' '
+                                        << radius << " 0 0 0 " << bl;
+    else if (configs.defaultIconStyle == DIS::square)
+        svg.open("path").beginAttr("d")
+            << "M " << tr << " H " << bl.x() << " V " << bl.y();
+    else
+        return;
+    svg.endAttr().beginAttr("style");
+
+    // Set style for color template
+    // Set some defaults
+    if (!has(CBK::fill))
+        svg.prop("fill", "none");
+    if (has(CBK::stroke)) {
+        svg.prop("stroke-width", IC::colorStrokeWidth);
+    } else if (has(CBK::strokeDashArray) || has(CBK::strokeDashOffset)) {
+        svg.prop("stroke", "#fff");
+        svg.prop("stroke-width", IC::otherStrokeWidth);
+    }
+
+    for (CBK::Key key :
+         {CBK::fill, CBK::stroke, CBK::strokeDashArray, CBK::strokeDashOffset})
+        if (has(key))
+            svg.prop(CBK::name(key), info.styles()[key]);
+    svg.endAttr().close();
+}
+
+/// @brief Generate the checkerboard used by _genOpacitySvg(), to put in defs
+static void _genCheckerboardSvg(SvgWriter &svg) {
+    namespace IC = C::IC;
+    constexpr qreal w = IC::checkerboardWidth;
+    svg.open("pattern")
+        .attr("id", "__checkerboard")
+        .attr("patternUnits", "userSpaceOnUse")
+        .attr("width", 2 * w)
+        .attr("height", 2 * w);
+    for (auto [x, y, fill] :
+         {std::tuple(0., 0., "#777"), std::tuple(0., w, "#fff"),
+          std::tuple(w, w, "#777"), std::tuple(w, 0., "#fff")})
+        svg.open("rect")
+            .attr("x", x)
+            .attr("y", y)
+            .attr("width", w)
+            .attr("height", w)
+            .attr("fill", fill)
+            .close();
+    svg.close();
+}
+
+/// @note Uses the pattern of _genCheckerboardSvg()
+static void _genOpacitySvg(
+    SvgWriter &svg, const Configs &configs, const StandardButtonInfo &info,
+    const QPointF &bl, const QPointF &tr, qreal radius) {
+    namespace IC = C::IC;
+    using CBK = StyleRecord;
+    namespace DIS = C::C::G::V::DIS;
+    auto has = [&](CBK::Key k) -> bool { return info.styles().contains(k); };
+
+    // The background and the element share the geometry
+    auto openElement = [&] {
+        if (configs.defaultIconStyle == DIS::circle)
+            svg.open("path").beginAttr("d") << "M " << bl << " A " << radius
+                                            << ' ' << radius << " 0 0 0 " << tr;
+        else
+            svg.open("path").beginAttr("d")
+                << "M " << bl << " H " << tr.x() << " V " << tr.y();
+        svg.endAttr().beginAttr("style");
+    };
+    if (configs.defaultIconStyle != DIS::circle
+        && configs.defaultIconStyle != DIS::square)
+        return;
+
+    // Set style for the background
+    openElement();
+    if (!has(CBK::fillOpacity))
+        svg.prop("fill-opacity", 0);
+    else
+        svg.prop("fill", "url(#__checkerboard)");
+    if (has(CBK::strokeOpacity)) {
+        svg.prop("stroke-width", IC::colorStrokeWidth);
+        svg.prop("stroke", "url(#__checkerboard)");
+    }
+    svg.endAttr().close();
+
+    // Set style for color template
+    openElement();
+    // Set some defaults
+    if (!has(CBK::fillOpacity))
+        svg.prop("fill-opacity", 0);
+    else if (!has(CBK::fill))
+        svg.prop("fill", "#fff");
+    if (has(CBK::strokeOpacity)) {
+        if (!has(CBK::stroke))
+            svg.prop("stroke", "#fff");
+        svg.prop("stroke-width", IC::colorStrokeWidth);
+    }
+
+    for (CBK::Key key :
+         {CBK::fill, CBK::stroke, CBK::stroke, CBK::fillOpacity,
+          CBK::strokeOpacity})
+        if (has(key))
+            svg.prop(CBK::name(key), info.styles()[key]);
+    svg.endAttr().close();
+}
+
+static void _genStrokeWidthSvg(
+    SvgWriter &svg, const Configs &configs, const StandardButtonInfo &info,
+    const QPointF &stl, const QPointF &str, qreal sradius) {
+    using CBK = StyleRecord;
+    namespace DIS = C::C::G::V::DIS;
+
+    if (configs.defaultIconStyle == DIS::circle)
+        svg.open("path").beginAttr("d") << "M " << str << " A " << sradius
+                                        << ' ' << sradius << " 0 0 0 " << stl;
+    else if (configs.defaultIconStyle == DIS::square)
+        svg.open("path").beginAttr("d") << "M " << str << " H " << stl.x();
+    else
+        return;
+
+    svg.endAttr()
+        .beginAttr("style")
+        .prop("fill-opacity", 0)
+        .prop("stroke", "#fff")
+        .prop("stroke-width", info.styles()[CBK::strokeWidth])
+        .endAttr()
+        .close();
+}
+
+static void _genStrokeCapSvg(
+    SvgWriter &svg, const StandardButtonInfo &info, const QPointF &cb,
+    const QPointF &cm, const QPointF &ce) {
+    namespace IC = C::IC;
+    using CBK = StyleRecord;
+
+    svg.open("path").beginAttr("d")
+        << "M " << cb << " L " << cm << " L " << ce;
+    svg.endAttr()
+        .beginAttr("style")
+        .prop("fill-opacity", 0)
+        .prop("stroke", "#fff")
+        .prop("stroke-width", IC::colorStrokeWidth)
+        .prop(
+            CBK::name(CBK::strokeLineCap), info.styles()[CBK::strokeLineCap])
+        .endAttr()
+        .close();
+}
+
+static void _genStrokeJoinSvg(
+    SvgWriter &svg, const StandardButtonInfo &info, const QPointF &jb,
+    const QPointF &jm, const QPointF &je) {
+    namespace IC = C::IC;
+    using CBK = StyleRecord;
+    auto has = [&](CBK::Key k) -> bool { return info.styles().contains(k); };
+
+    svg.open("path").beginAttr("d")
+        << "M " << jb << " L " << jm << " L " << je;
+    svg.endAttr()
+        .beginAttr("style")
+        .prop("fill-opacity", 0)
+        .prop("stroke", "#fff")
+        .prop("stroke-width", IC::colorStrokeWidth);
+    if (has(CBK::strokeLineJoin))
+        svg.prop(
+            CBK::name(CBK::strokeLineJoin),
+            info.styles()[CBK::strokeLineJoin]);
+    svg.endAttr().close();
+}
+
+static void _genMarkerSvg(
+    SvgWriter &svg, const StandardButtonInfo &info, const QPointF &mbl,
+    const QPointF &mbr) {
+    using CBK = StyleRecord;
+    auto has = [&](CBK::Key k) -> bool { return info.styles().contains(k); };
+
+    qreal start = mbl.x(), end = mbr.x(), mid = (mbl.x() + mbr.x()) / 2;
+    if (!has(CBK::markerStart))
+        start = mid;
+    if (!has(CBK::markerEnd))
+        end = mid;
+
+    svg.open("path").beginAttr("d")
+        << "M " << start << ' ' << mbl.y() << " H " << mid << " H " << end;
+    svg.endAttr()
+        .beginAttr("style")
+        .prop("stroke-width", 2)
+        .prop("stroke", "#fff");
+    for (CBK::Key key : {CBK::markerStart, CBK::markerEnd, CBK::markerMid})
+        if (has(key))
+            svg.prop(CBK::name(key), info.styles()[key]);
+    svg.endAttr().close();
+}
+
+static void _genFontSvg(
+    SvgWriter &svg, const Configs &configs, const StandardButtonInfo &info,
+    const QSizeF &size, qreal baselineHeight) {
+    using CBK = StyleRecord;
+    auto has = [&](CBK::Key k) -> bool { return info.styles().contains(k); };
+
+    svg.open("text")
+        .attr("x", size.width() * 0.5)
+        .attr("y", baselineHeight)
+        .attr("fill", "#fff")
+        .beginAttr("style")
+        // Set default fsize
+        .prop("font-size", size.height() * 0.5)
+        // Correctly position the text
+        .prop("text-anchor", "middle")
+        .prop("fill", "#fff");
+    for (CBK::Key key : {CBK::fontFamily, CBK::fontStyle})
+        if (has(key))
+            svg.prop(CBK::name(key), info.styles()[key]);
+    svg.endAttr().content(configs.defaultIconText).close();
+}
+
+static void _genFontSizeSvg(
+    SvgWriter &svg, const StandardButtonInfo &info, const QSizeF &size,
+    qreal baselineHeight) {
+    using CBK = StyleRecord;
+    svg.open("text")
+        .attr("x", size.width() * 0.6)
+        .attr("y", baselineHeight)
+        .attr("fill", "#fff")
+        .beginAttr("style")
+        .prop("font-size", size.height() * 0.15)
+        .prop("font-family", "sans-serif")
+        .prop("text-anchor", "begin")
+        .prop("fill", "#fff")
+        .endAttr()
+        .content(info.styles()[CBK::fontSize])
+        .close();
+}
+
+/// @brief Start an icon, leaving the defs element open
+static void _openSvg(SvgWriter &svg, const QSizeF &size) {
+    svg.open("svg")
+        .attr("width", size.width())
+        .attr("height", size.height())
+        .attr("version", "1.1");
+    svg.beginAttr("viewBox") << "0 0 " << size.width() << ' ' << size.height();
+    svg.endAttr().attr("xmlns", "http://www.w3.org/2000/svg").open("defs");
+}
+
+QByteArray genIndicatorsSvg(
+    const IndicatorAnchors &a, const Configs &configs,
+    const StandardButtonInfo &info, Indicators indicators) {
+    auto shows = [&](Indicator indicator) -> bool {
+        return (indicators & (1u << int(indicator)))
+               && showsIndicator(info.styles(), indicator);
+    };
+
+    // 1. Add necessary definitions
+    SvgWriter svg;
+    _openSvg(svg, a.size);
+    svg.content(info.getDisplayDefsSvg());
+    if (shows(Indicator::Opacity))
+        _genCheckerboardSvg(svg);
+    svg.close();
+
+    // 1.1 Generate a indicator if this is a non-standard style
+    if (info.isEmpty())
+        _genQuestionMarkSvg(svg, a.size, a.questionBaseline);
+
+    // 2. Draw the fill/stroke color/style indicator
+    if (shows(Indicator::Color))
+        _genColorSvg(svg, configs, info, a.bl, a.tr, a.R);
+
+    // 3. Draw the stroke/fill opacity indicator
+    if (shows(Indicator::Opacity))
+        _genOpacitySvg(svg, configs, info, a.bl, a.tr, a.R);
+
+    // 4. Draw stroke-width indicator
+    if (shows(Indicator::StrokeWidth))
+        _genStrokeWidthSvg(svg, configs, info, a.stl, a.str, a.sR);
+
+    // 5.1: draw stroke-linecap indicator
+    if (shows(Indicator::StrokeCap))
+        _genStrokeCapSvg(svg, info, a.cb, a.cm, a.ce);
+
+    // 5.2: draw stroke-linejoin indicator
+    if (shows(Indicator::StrokeJoin))
+        _genStrokeJoinSvg(svg, info, a.jb, a.jm, a.je);
+
+    // 6. Draw marker start/end/mid indicator
+    if (shows(Indicator::Marker))
+        _genMarkerSvg(svg, info, a.mbl, a.mbr);
+
+    // 7. Draw font-style indicator
+    if (shows(Indicator::Font))
+        _genFontSvg(svg, configs, info, a.size, a.fontBaseline);
+
+    // 8. Draw font-size indicator
+    if (shows(Indicator::FontSize))
+        _genFontSizeSvg(svg, info, a.size, a.fontSizeBaseline);
+
+    // Compose final icon
+    svg.close();
+    return svg.take();
+}
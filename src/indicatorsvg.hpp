@@ -0,0 +1,18 @@
+#ifndef INDICATORSVG_HPP
+#define INDICATORSVG_HPP
+
+#include "buttoninfo.hpp"
+#include "configs.hpp"
+#include "indicatorpainter.hpp"
+
+#include <QByteArray>
+
+/// @brief Generate the icon of a standard style, to be rendered by resvg
+/// @details IndicatorPainter draws the same icon for the styles it can.
+/// A question mark is drawn if @p info has no styles.
+/// @param indicators Which of the indicators to draw
+QByteArray genIndicatorsSvg(
+    const IndicatorAnchors &anchors, const Configs &configs,
+    const StandardButtonInfo &info, Indicators indicators = allIndicators);
+
+#endif // INDICATORSVG_HPP
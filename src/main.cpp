@@ -36,8 +36,21 @@ int main(int argc, char *argv[]) try {
     if (!QDir(configPath).exists(EXE_NAME_STR))
         QDir(configPath).mkdir(EXE_NAME_STR);
     configPath += "/" EXE_NAME_STR;
+
+    // Cache is optional, skip it if not available
+    QString cachePath =
+        QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (!cachePath.isEmpty() && QDir(cachePath).mkpath(EXE_NAME_STR))
+        cachePath += "/" EXE_NAME_STR;
+    else
+        cachePath.clear();
+
+    // Fonts take a while to load, do it while the configs are parsed
+    Panel::loadFontsAsync(cachePath);
+
     QSharedPointer<Configs> configs(new Configs(
-        configPath + "/config.yaml", configPath + "/config.generated.yaml"));
+        configPath + "/config.yaml", configPath + "/config.generated.yaml",
+        cachePath));
 
     // Don't quit on last window closed
     QApplication a(argc, argv);
@@ -52,25 +65,44 @@ int main(int argc, char *argv[]) try {
     QString styleSheet(file.readAll());
     a.setStyleSheet(styleSheet);
 
+    // Make sure saved styles hit the disk before quitting
+    QObject::connect(
+        &a, &QCoreApplication::aboutToQuit, configs.data(),
+        &Configs::flushGeneratedConfig);
+
+    if (!cachePath.isEmpty())
+        Panel::enableIconDiskCache(cachePath);
+    Panel::setIconCacheBudget(configs->iconCacheMb);
+    // Start rendering icons before the first panel opens
+    Panel::warmUpIcons(configs);
+
+    // Pick up config changes without restarting, keeping warm icon caches
+    if (configs->watchConfig) {
+        QObject::connect(
+            configs.data(), &Configs::iconsInvalidated,
+            &Panel::invalidateIcons);
+        QObject::connect(
+            configs.data(), &Configs::allIconsInvalidated, &Panel::clearIcons);
+        configs->watchUserConfig();
+    }
+
+    // The root panel is built hidden once, then reused by every hotkey press
+    QSharedPointer<Panel> panel(new Panel(nullptr, 0, configs));
+    panel->reset();
+
     // Register hotkeys
-    QSharedPointer<Panel> panel(nullptr);
     QSharedPointer<QHotkey> hotkey1;
     if (!configs->shortcutMainPanel.isEmpty()) {
         hotkey1 = QSharedPointer<QHotkey>(
             new QHotkey(QKeySequence(configs->shortcutMainPanel), true, &a));
         QObject::connect(hotkey1.data(), &QHotkey::activated, qApp, [&]() {
             qDebug() << "Hotkey Activated";
-            if (!panel)
-                panel = QSharedPointer<Panel>(new Panel(nullptr, 0, configs));
-            panel->show();
+            panel->popUp();
         });
         QObject::connect(hotkey1.data(), &QHotkey::released, qApp, [&]() {
             qDebug() << "Hotkey Released";
-            if (panel) {
-                panel->copyStyle();
-                panel->close();
-            }
-            panel = nullptr;
+            panel->copyStyle();
+            panel->reset();
             Utils::pasteStyleToInkscape();
         });
     }
@@ -1,652 +1,788 @@
 #include "panel.hpp"
 
 #include "constants.hpp"
+#include "fontindex.hpp"
+#include "icondiskcache.hpp"
+#include "iconmemorycache.hpp"
+#include "indicatorpainter.hpp"
+#include "indicatorsvg.hpp"
 #include "pugixml.hpp"
+#include "svgrefscanner.hpp"
 
 #include <QApplication>
-#include <QCache>
 #include <QClipboard>
 #include <QCursor>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QLayout>
 #include <QMimeData>
 #include <QMoveEvent>
+#include <QMutex>
 #include <QPainter>
 #include <QPalette>
 #include <QPolygon>
 #include <QPolygonF>
+#include <QPointer>
 #include <QPushButton>
 #include <QRegion>
-#include <QRegularExpression>
+#include <QScreen>
 #include <QSvgRenderer>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 #include <QToolTip>
 #include <QVector>
 #include <QtDebug>
 #include <QtMath>
 #include <algorithm>
+#include <functional>
+#include <future>
+#include <map>
+#include <numeric>
 #include <sstream>
 
 uint qHash(const QPoint &point, uint seed = 0) {
     return qHash(QPair<int, int>(point.x(), point.y()), seed);
 }
 
-static QString _genQuestionMarkSvg(Button *button, qreal baselineHeight) {
-    QSizeF size = button->inactiveGeometry.size() * button->hoverScale;
-    return QString(R"(<text x="%1" y="%2" fill="#fff" style="%3">?</text>)")
-        .arg(size.width() * 0.5)
-        .arg(baselineHeight)
-        .arg(QString("font-size:%1;text-anchor:middle")
-                 .arg(size.height() * 0.5));
+/// @brief Cache rendered icons and reuse them if configs not changed.
+/// @details Icons are keyed by the fingerprint of the styles they show, so a
+/// lookup compares integers only, and buttons of the same styles share their
+/// icons. A changed style gets a new fingerprint, the icons of the old one age
+/// out. Central button icons are composited from the indicators of the
+/// composed styles, each cached by the fingerprint of the styles it is drawn
+/// from. So when one style changes, only its indicator is drawn again. The
+/// size is in device pixels, so each state of a button and each device pixel
+/// ratio has its own icon. Icons are kept as images, panels copy them to their
+/// icon atlas before showing them. Nothing is cached until
+/// Panel::setIconCacheBudget().
+static IconMemoryCache iconCache(0);
+
+/// @brief Icons rendered by earlier runs. Null if disabled.
+static std::unique_ptr<IconDiskCache> iconDiskCache;
+
+/// @brief Increases whenever cached icons are invalidated, so that icons
+/// rendered in the background before that can be told apart
+static quint64 iconGeneration = 0;
+
+/// @brief Where an icon is drawn
+struct IconFrame {
+    /// @brief Size of the icon, as large as the hovered button
+    QSizeF size;
+    /// @brief Centroid of the button, relative to the icon
+    QPointF centroid;
+    /// @brief Sizes the icon is shown at, indexed by Button::IconState
+    std::array<QSize, Button::numIconStates> stateSizes;
+};
+
+static IconFrame _genIconFrame(const Button *button) {
+    return {
+        button->inactiveGeometry.size() * button->hoverScale,
+        button->centroid * button->hoverScale,
+        {button->stateSize(Button::Inactive),
+         button->stateSize(Button::Hovered)}};
 }
 
-static QString _genSvgDefs(const Configs &conf, const ButtonInfo &info) {
-    QString svgDefs = info.genDefsSvg(conf.getSvgDefs());
-    // Replace non-displayable attributes so that markers can be displayed.
-    static QRegularExpression _ctx_re(R"(\b(context-stroke|context-fill)\b)");
-    svgDefs.replace(_ctx_re, "#fff");
-    return svgDefs;
+/// @brief Size to render an icon at, so that it's drawn without scaling
+/// @return The size in device pixels
+static QSize
+_genIconSize(const IconFrame &frame, Button::IconState state, qreal dpr) {
+    return frame.stateSizes[state] * dpr;
 }
 
-static QString _genColorSvg(
-    const Configs &configs, const StandardButtonInfo &info, const QPointF &bl,
-    const QPointF &tr, qreal radius) {
-    namespace IC = C::IC;
-    namespace CBK = C::C::B::K;
-    namespace DIS = C::C::G::V::DIS;
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-
-    // Set geometry for the svg element
-    QString element;
-    if (configs.defaultIconStyle == DIS::circle) {
-        element =
-            QString(R"(<path d="M %1 %2 A %3 %3 0 0 0 %4 %5" style="{S}"/>)")
-                .arg(tr.x())
-                .arg(tr.y())
-                .arg(radius)
-                .arg(bl.x())
-                .arg(bl.y());
-    } else if (configs.defaultIconStyle == DIS::square) {
-        element = QString(R"(<path d="M %1 %2 H %3 V %4" style="{S}"/>)")
-                      .arg(tr.x())
-                      .arg(tr.y())
-                      .arg(bl.x())
-                      .arg(bl.y());
-    }
-
-    // Set style for color template
-    QStringList styleString;
-    // Set some defaults
-    if (!has(CBK::fill))
-        styleString.append("fill:none");
-    if (has(CBK::stroke))
-        styleString.append(
-            QString("stroke-width:%1").arg(IC::colorStrokeWidth));
-    else if (has(CBK::strokeDashArray) || has(CBK::strokeDashOffset))
-        styleString.append(
-            QString("stroke:#fff;stroke-width:%1").arg(IC::otherStrokeWidth));
-
-    for (const char *key :
-         {CBK::fill, CBK::stroke, CBK::strokeDashArray, CBK::strokeDashOffset})
-        if (has(key))
-            styleString.append(key + (":" + info.styles()[key]));
-    return element.replace("{S}", styleString.join(";"));
-}
-
-static QPair<QString, QString> _genOpacitySvg(
-    const Configs &configs, const StandardButtonInfo &info, const QPointF &bl,
-    const QPointF &tr, qreal radius) {
-    namespace IC = C::IC;
-    namespace CBK = C::C::B::K;
-    namespace DIS = C::C::G::V::DIS;
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-
-    QString checkerboard =
-        QString(R"(<pattern id="__checkerboard" patternUnits="userSpaceOnUse")"
-                R"( width="%1" height="%1">)"
-                R"(  <rect x="0" y="0" width="%2" height="%2" fill="#777"/>)"
-                R"(  <rect x="0" y="%2" width="%2" height="%2" fill="#fff"/>)"
-                R"(  <rect x="%2" y="%2" width="%2" height="%2" fill="#777"/>)"
-                R"(  <rect x="%2" y="0" width="%2" height="%2" fill="#fff"/>)"
-                R"(</pattern>)")
-            .arg(2 * IC::checkerboardWidth)
-            .arg(IC::checkerboardWidth);
-    QString svgDefs = checkerboard;
-
-    QString background, element, svgContent;
-    if (configs.defaultIconStyle == DIS::circle) {
-        background = element =
-            QString(R"(<path d="M %1 %2 A %3 %3 0 0 0 %4 %5" style="{S}"/>)")
-                .arg(bl.x())
-                .arg(bl.y())
-                .arg(radius)
-                .arg(tr.x())
-                .arg(tr.y());
-    } else if (configs.defaultIconStyle == DIS::square) {
-        background = element =
-            QString(R"(<path d="M %1 %2 H %3 V %4" style="{S}"/>)")
-                .arg(bl.x())
-                .arg(bl.y())
-                .arg(tr.x())
-                .arg(tr.y());
-    }
+/// @brief Size of a panel, the bounding box of the hexagon
+static QSize _genPanelSize(qreal unitLen) {
+    using C::R60;
+    return {
+        int(unitLen * (2 + 2 / 3.)), int(unitLen * qSin(R60) * (2 + 2 / 3.))};
+}
 
-    // Set style for color template
-    QStringList styleString;
-    QStringList bgStyleString;
-    // Set some defaults
-    if (!has(CBK::fillOpacity)) {
-        styleString.append("fill-opacity:0");
-        bgStyleString.append("fill-opacity:0");
-    } else {
-        if (!has(CBK::fill))
-            styleString.append("fill:#fff");
-        bgStyleString.append("fill:url(#__checkerboard)");
-    }
+/// @brief Calculate the vertices of a style button, see
+/// Panel::genStyleButtonMask()
+static QVector<QPointF> _genStyleButtonVertices(
+    const QSizeF &panelSize, qreal unitLen, qreal gapLen, quint8 tSlot,
+    quint8 rSlot, quint8 subSlot) {
+    using C::R30, C::R60;
 
-    if (has(CBK::strokeOpacity)) {
-        if (!has(CBK::stroke))
-            styleString.append("stroke:#fff");
-        styleString.append(
-            QString("stroke-width:%1").arg(IC::colorStrokeWidth));
-        bgStyleString.append(
-            QString("stroke-width:%1").arg(IC::colorStrokeWidth));
-        bgStyleString.append("stroke:url(#__checkerboard)");
-    }
+    // Upper half of the hexagon:
+    /*
+    **       •---•---•---•
+    **      / \ / \ / \ / \
+    **     •---•---•---•---•
+    **    / \ / \ / \ / \ / \
+    **   •---•---•---•---2---3
+    **  / \ / \ / \ / \ / \ / \
+    ** •---•---•---C-->•-->1-->2
+    */
+    // -->: the tSlot direction
+    // C: center of the hexagon
+    // •: triangle vertices
+    // 1: the 1st point
+    // 2: the 2nd point
+    // 3: the 3rd point
 
-    background.replace("{S}", bgStyleString.join(';'));
-    svgContent += background;
+    // Vertex of the triangular button (coordinates relative to panel)
+    return {
+        {
+            // The 1st point
+            panelSize.width() / 2.
+                // Base x
+                + ((rSlot * qCos(tSlot * R60)
+                    + (subSlot / 2) * qCos((tSlot + 2) * R60))
+                       * unitLen / 3.
+                   // Offset for border
+                   + gapLen * qCos((tSlot + 0.5 + (subSlot % 2)) * R60)),
+            panelSize.height() / 2.
+                // Base y
+                - ((rSlot * qSin(tSlot * R60)
+                    + (subSlot / 2) * qSin((tSlot + 2) * R60))
+                       * unitLen / 3.
+                   // Offset for border
+                   + gapLen * qSin((tSlot + 0.5 + (subSlot % 2)) * R60)),
+        },
+        {
+            // The 2nd point
+            panelSize.width() / 2.
+                + (((rSlot + 1 - (subSlot % 2)) * qCos(tSlot * R60)
+                    + ((subSlot + 1) / 2) * qCos((tSlot + 2) * R60))
+                       * unitLen / 3.
+                   + gapLen * qCos((tSlot + 2.5 - (subSlot % 2) * 3) * R60)),
+            panelSize.height() / 2.
+                - (((rSlot + 1 - (subSlot % 2)) * qSin(tSlot * R60)
+                    + ((subSlot + 1) / 2) * qSin((tSlot + 2) * R60))
+                       * unitLen / 3.
+                   + gapLen * qSin((tSlot + 2.5 - (subSlot % 2) * 3) * R60)),
+        },
+        {
+            // The 3rd point
+            panelSize.width() / 2.
+                + (((rSlot + 1) * qCos(tSlot * R60)
+                    + (subSlot / 2 + 1) * qCos((tSlot + 2) * R60))
+                       * unitLen / 3.
+                   + gapLen * qCos((tSlot - 1.5 - (subSlot % 2)) * R60)),
+            panelSize.height() / 2.
+                - (((rSlot + 1) * qSin(tSlot * R60)
+                    + (subSlot / 2 + 1) * qSin((tSlot + 2) * R60))
+                       * unitLen / 3.
+                   + gapLen * qSin((tSlot - 1.5 - (subSlot % 2)) * R60)),
+        }};
+}
 
-    for (const char *key :
-         {CBK::fill, CBK::stroke, CBK::stroke, CBK::fillOpacity,
-          CBK::strokeOpacity})
-        if (has(key))
-            styleString.append(key + (":" + info.styles()[key]));
-    svgContent += element.replace("{S}", styleString.join(';'));
-    return {svgDefs, svgContent};
+/// @brief Icon frames of style buttons, indexed by SlotIndex::local()
+/// @details They are the same in all panels, as the buttons are laid out the
+/// same way as Panel::addStyleButton() does.
+static const std::array<IconFrame, SlotIndex::perPanel> &_genIconFrames() {
+    static const auto frames = [] {
+        using namespace C::PG;
+        std::array<IconFrame, SlotIndex::perPanel> frames;
+        QSize panelSize = _genPanelSize(unitLen);
+        for (quint8 t = 0; t < 6; ++t)
+            for (quint8 r = 0; r <= 2; ++r)
+                for (quint8 sub = 0; sub <= r * 2; ++sub) {
+                    QVector<QPointF> points = _genStyleButtonVertices(
+                        panelSize, unitLen, gapLen, t, r, sub);
+                    QPointF centroid =
+                        std::reduce(points.begin(), points.end()) / 3.;
+                    QRectF geometry(QPolygonF(points).boundingRect());
+                    centroid -= geometry.topLeft();
+                    QRect hoverGeometry = Button::genHoverGeometry(
+                        geometry, centroid, hoverScale);
+                    frames[SlotIndex::local(t, r, sub)] = {
+                        geometry.size() * hoverScale,
+                        centroid * hoverScale,
+                        {geometry.toRect().size(), hoverGeometry.size()}};
+                }
+        return frames;
+    }();
+    return frames;
 }
 
-static QString _genStrokeWidthSvg(
-    const Configs &configs, const StandardButtonInfo &info, const QPointF &stl,
-    const QPointF &str, qreal sradius) {
-    namespace IC = C::IC;
-    namespace CBK = C::C::B::K;
-    namespace DIS = C::C::G::V::DIS;
+/// @brief Where icons of style buttons go in the icon atlas of a panel, in
+/// device pixels
+struct IconAtlasLayout {
+    QSize size;
+    /// @brief Indexed by Button::IconState, then SlotIndex::local(), so that
+    /// each state of each tSlot has a row
+    std::array<std::array<QRect, SlotIndex::perPanel>, Button::numIconStates>
+        tiles;
+};
+
+/// @param dpr Device pixel ratio of the panel
+/// @param root Whether the layout is for the root panel, which has no buttons
+/// at rSlot 0 and so gets no tiles for them
+static const IconAtlasLayout &_genIconAtlasLayout(qreal dpr, bool root) {
+    // One per screen the panels have been on
+    static std::map<std::pair<qreal, bool>, IconAtlasLayout> layouts;
+    if (auto it = layouts.find({dpr, root}); it != layouts.end())
+        return it->second;
+
+    // rSlot 0 is the first button of each tSlot
+    const int numSkipped = root ? 1 : 0;
+    const int numColumns = SlotIndex::perTSlot - numSkipped;
+    constexpr int numStates = Button::numIconStates;
+    const auto &frames = _genIconFrames();
+    QSize cell;
+    for (int i = 0; i < int(frames.size()); ++i)
+        if (i % SlotIndex::perTSlot >= numSkipped)
+            for (int state = 0; state < numStates; ++state)
+                cell = cell.expandedTo(
+                    _genIconSize(frames[i], Button::IconState(state), dpr));
+
+    IconAtlasLayout &layout = layouts[{dpr, root}];
+    layout.size = {
+        cell.width() * numColumns,
+        cell.height() * int(frames.size() / SlotIndex::perTSlot) * numStates};
+    for (int state = 0; state < numStates; ++state)
+        for (int i = 0; i < int(frames.size()); ++i) {
+            int column = i % SlotIndex::perTSlot - numSkipped;
+            if (column < 0)
+                continue;
+            int row = i / SlotIndex::perTSlot * numStates + state;
+            layout.tiles[state][i] = {
+                QPoint(column * cell.width(), row * cell.height()),
+                _genIconSize(frames[i], Button::IconState(state), dpr)};
+        }
+    return layout;
+}
 
-    QString element;
-    if (configs.defaultIconStyle == DIS::circle) {
-        element =
-            QString(R"(<path d="M %1 %2 A %3 %3 0 0 0 %4 %5" style="{S}"/>)")
-                .arg(str.x())
-                .arg(str.y())
-                .arg(sradius)
-                .arg(stl.x())
-                .arg(stl.y());
-    } else if (configs.defaultIconStyle == DIS::square) {
-        element = QString(R"(<path d="M %1 %2 H %3" style="{S}"/>)")
-                      .arg(str.x())
-                      .arg(str.y())
-                      .arg(stl.x());
+/// @brief Generate the icon of a style button
+static QByteArray _genStyleIconSvg(
+    const IconFrame &frame, const Configs &configs,
+    const Configs::ResolvedButton &resolved, bool orientation) {
+    if (resolved.kind == Configs::SlotKind::Standard) {
+        const StandardButtonInfo &info = resolved.standard();
+        return info.getIconSvg().isEmpty()
+                   ? genIndicatorsSvg(
+                         genStyleButtonAnchors(
+                             frame.size, frame.centroid, configs, orientation),
+                         configs, info)
+                   : info.getIconSvg();
     }
+    if (resolved.kind == Configs::SlotKind::Custom) {
+        const CustomButtonInfo &info = resolved.custom();
+        return info.getIconSvg().isEmpty()
+                   ? genIndicatorsSvg(
+                         genStyleButtonAnchors(
+                             frame.size, frame.centroid, configs, orientation),
+                         configs, StandardButtonInfo())
+                   : info.getIconSvg();
+    }
+    return {};
+}
+
+/// @brief Draw the icon of a style button with QPainter if it's simple enough,
+/// which is much faster than rendering its svg
+/// @param size Size of the icon in device pixels
+/// @return A null image if the svg has to be rendered instead
+static QImage _paintStyleIcon(
+    const IconFrame &frame, const QSize &size, const Configs &configs,
+    const Configs::ResolvedButton &resolved, bool orientation) {
+    if (resolved.kind != Configs::SlotKind::Standard
+        || !resolved.standard().getIconSvg().isEmpty())
+        return QImage();
+    return IndicatorPainter::paint(
+        genStyleButtonAnchors(frame.size, frame.centroid, configs, orientation),
+        size, configs, resolved.standard());
+}
 
-    QStringList styleString;
-    styleString.append("fill-opacity:0");
-    styleString.append("stroke:#fff");
-    styleString.append(
-        QString("stroke-width:%1").arg(info.styles()[CBK::strokeWidth]));
-    return element.replace("{S}", styleString.join(';'));
-}
-
-static QString _genStrokeCapSvg(
-    const StandardButtonInfo &info, const QPointF &cb, const QPointF &cm,
-    const QPointF &ce) {
-    namespace IC = C::IC;
-    namespace CBK = C::C::B::K;
-
-    QString element =
-        QString(R"(<path d="M %1 %2 L %3 %4 L %5 %6" style="{S}"/>)")
-            .arg(cb.x())
-            .arg(cb.y())
-            .arg(cm.x())
-            .arg(cm.y())
-            .arg(ce.x())
-            .arg(ce.y());
-    QStringList styleString;
-    styleString.append("fill-opacity:0");
-    styleString.append("stroke:#fff");
-    styleString.append(QString("stroke-width:%1").arg(IC::colorStrokeWidth));
-    styleString.append(
-        CBK::strokeLineCap + (":" + info.styles()[CBK::strokeLineCap]));
-    return element.replace("{S}", styleString.join(';'));
-}
-
-static QString _genStrokeJoinSvg(
-    const StandardButtonInfo &info, const QPointF &jb, const QPointF &jm,
-    const QPointF &je) {
-    namespace IC = C::IC;
-    namespace CBK = C::C::B::K;
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-
-    QString element =
-        QString(R"(<path d="M %1 %2 L %3 %4 L %5 %6" style="{S}"/>)")
-            .arg(jb.x())
-            .arg(jb.y())
-            .arg(jm.x())
-            .arg(jm.y())
-            .arg(je.x())
-            .arg(je.y());
-    QStringList styleString;
-    styleString.append("fill-opacity:0");
-    styleString.append("stroke:#fff");
-    styleString.append(QString("stroke-width:%1").arg(IC::colorStrokeWidth));
-    if (has(CBK::strokeLineJoin))
-        styleString.append(
-            CBK::strokeLineJoin + (":" + info.styles()[CBK::strokeLineJoin]));
-    return element.replace("{S}", styleString.join(';'));
-}
-
-static QString _genMarkerSvg(
-    const StandardButtonInfo &info, const QPointF &mbl, const QPointF &mbr) {
-    namespace CBK = C::C::B::K;
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-
-    qreal start = mbl.x(), end = mbr.x(), mid = (mbl.x() + mbr.x()) / 2;
-    if (!has(CBK::markerStart))
-        start = mid;
-    if (!has(CBK::markerEnd))
-        end = mid;
-
-    QString element = QString(R"(<path d="M %1 %2 H %3 H %4" style="{S}"/>)")
-                          .arg(start)
-                          .arg(mbl.y())
-                          .arg(mid)
-                          .arg(end);
-    QStringList styleString;
-    styleString.append("stroke-width:2");
-    styleString.append("stroke:#fff");
-    for (const char *key : {CBK::markerStart, CBK::markerEnd, CBK::markerMid})
-        if (has(key))
-            styleString.append(key + (":" + info.styles()[key]));
-    return element.replace("{S}", styleString.join(';'));
-}
-
-static QString _genFontSvg(
-    const Configs &configs, const StandardButtonInfo &info, const QSizeF &size,
-    qreal baselineHeight) {
-    namespace CBK = C::C::B::K;
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-
-    QString element =
-        QString(R"(<text x="%1" y="%2" fill="#fff" style="{S}">%3</text>)")
-            .arg(size.width() * 0.5)
-            .arg(baselineHeight)
-            .arg(configs.defaultIconText);
-
-    QStringList styleString;
-
-    // Set default fsize
-    styleString.append(QString("font-size:%1").arg(size.height() * 0.5));
-    // Correctly position the text
-    styleString.append("text-anchor:middle");
-    styleString.append("fill:#fff");
-
-    for (const char *key : {CBK::fontFamily, CBK::fontStyle})
-        if (has(key))
-            styleString.append(key + (":" + info.styles()[key]));
-    return element.replace("{S}", styleString.join(';'));
-}
-
-static QString _genFontSizeSvg(
-    const StandardButtonInfo &info, const QSizeF &size, qreal baselineHeight) {
-    namespace CBK = C::C::B::K;
-    QString element =
-        QString(R"(<text x="%1" y="%2" fill="#fff" style="{S}">%3</text>)")
-            .arg(size.width() * 0.6)
-            .arg(baselineHeight)
-            .arg(info.styles()[CBK::fontSize]);
-
-    QStringList styleString;
-    styleString.append(QString("font-size:%1").arg(size.height() * 0.15));
-    styleString.append("font-family:sans-serif");
-    styleString.append("text-anchor:begin");
-    styleString.append("fill:#fff");
-
-    return element.replace("{S}", styleString.join(';'));
-}
-
-static QString _composeSvg(
-    const QSizeF &size, const QString &svgDefs, const QString &svgContent) {
-    return QString(R"(<svg width="%1" height="%2" version="1.1")"
-                   R"( viewBox="0 0 %1 %2" xmlns="http://www.w3.org/2000/svg">)"
-                   R"( <defs>%3</defs>%4</svg>)")
-        .arg(size.width())
-        .arg(size.height())
-        .arg(svgDefs, svgContent);
-}
-
-static QByteArray _genUnknownStyleSvg(Button *button, bool orientation) {
-    QSizeF size = button->inactiveGeometry.size() * button->hoverScale;
-    qreal baselineHeight = size.height() * (orientation ? 0.5 : 0.85);
-    return _composeSvg(size, {}, _genQuestionMarkSvg(button, baselineHeight))
-        .toUtf8();
-}
-
-static QByteArray _genStyleButtonSvg(
-    Button *button, const Configs &configs, const StandardButtonInfo &info,
+/// @brief Identify the icon of a style button
+/// @param resolved Must not be of SlotKind::None
+/// @param size Size of the icon in device pixels
+static IconKey _genStyleIconKey(
+    const Configs::ResolvedButton &resolved, const QSize &size,
     bool orientation) {
-    using C::R30, C::R60, C::R45, C::RAD;
-    namespace CGK = C::C::G::K;      // button configs Keys
-    namespace CBK = C::C::B::K;      // button configs Keys
-    namespace DIS = C::C::G::V::DIS; // default icon style
+    return {
+        IconKey::StyleButton, resolved.info->getFingerprint(), size,
+        quint8(orientation)};
+}
 
-    QSizeF size = button->inactiveGeometry.size() * button->hoverScale;
+/// @brief Copy an icon to keep it in the memory cache
+/// @details Icons loaded from the disk cache map their file, which shouldn't
+/// stay open for as long as the icon is cached.
+static QImage *_detachIcon(const QImage &icon) {
+    return new QImage(icon.copy());
+}
 
-    QString svgDefs;
-    QString svgContent;
+/// @brief Renders the icons of open panels on a thread pool
+/// @details Requests wait in a queue, and a free thread takes the most wanted
+/// one: urgent requests first, then those nearest the cursor. Since the order
+/// is decided as late as possible, moving the cursor elsewhere, or closing a
+/// panel (see cancel()), takes effect even for icons requested long before.
+/// Icons are handed back on the GUI thread, unless their context is gone.
+class Panel::IconRenderer : public QObject {
+public:
+    using Callback = std::function<void(const QImage &)>;
+
+    explicit IconRenderer(QObject *parent);
+    ~IconRenderer() override;
+
+    /// @brief The renderer shared by all panels
+    static IconRenderer &instance();
+
+    /// @brief Queue an icon for rendering
+    /// @param owner The panel to cancel the request with
+    /// @param context The request is dropped once this is deleted
+    /// @param pos Global position of the icon
+    /// @param urgent Whether to render before all non-urgent icons
+    /// @param done Called on the GUI thread with the icon, or with a null
+    /// image if the svg is invalid
+    void request(
+        const Panel *owner, QObject *context, const QPoint &pos, bool urgent,
+        const QByteArray &svg, const QSize &size, const Callback &done);
+
+    /// @brief Drop all queued requests of a panel
+    void cancel(const Panel *owner);
+
+    /// @brief Favor icons near the current cursor position
+    void focus();
+
+private:
+    struct Job {
+        const Panel *owner;
+        QPointer<QObject> context;
+        QPoint pos;
+        bool urgent;
+        QByteArray svg;
+        QSize size;
+        Callback done;
+    };
 
-    // 0. Generate a indicator if this is a non-standard style
-    qreal baselineHeight = size.height() * (orientation ? 0.5 : 0.85);
-    if (info.isEmpty())
-        svgContent += _genQuestionMarkSvg(button, baselineHeight);
+    /// @brief Render queued jobs until none is left, on a pool thread
+    void drain();
 
-    // 1.1 Calculate common anchor points for subsequent drawing
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-    // button's centroid
-    QPointF c = button->centroid * button->hoverScale;
-    // color indicator's anchor points
-    QPointF tr, bl;
-    // color/gradient indicator's radius
-    qreal R = size.height() / 3. - C::IC::colorStrokeWidth / 2.;
-    // stroke-width
-    qreal sR = size.height() * 11. / 24.;
-    // marker indicator's radius
-    qreal mR = size.height() / 3.;
-
-    qreal invert = orientation ? -1 : 1;
-    // qreal mR = size.height() * 3. / 8.;
-    if (configs.defaultIconStyle == DIS::circle) {
-        tr = c + QPointF(R * qCos(R60), -R * qSin(R60));
-        bl = c + QPointF(-R * qCos(R60), R * qSin(R60));
-    } else if (configs.defaultIconStyle == DIS::square) {
-        tr = c + QPointF(R * qCos(R45), -R * qSin(R45));
-        bl = c + QPointF(-R * qCos(R45), R * qSin(R45));
-        sR *= 2. / qSqrt(3.);
-    }
-    // stroke-width indicator's anchor points
-    QPointF str = c + QPointF(sR * qCos(R60), -sR * qSin(R60)) * invert;
-    QPointF stl = c + QPointF(-sR * qCos(R60), -sR * qSin(R60)) * invert;
-    // marker indicator's anchor points
-    QPointF mbl = c + QPointF(-mR * qCos(R45), mR * qSin(R45) * invert);
-    QPointF mbr = c + QPointF(mR * qCos(R45), mR * qSin(R45) * invert);
-    // line-cap indicator's anchor points
-    QPointF cb =
-        c + QPointF(-mR * qSin(R45) / qTan(RAD(40)), mR * qSin(R45) * invert);
-    QPointF cm =
-        c + QPointF(-mR * qSin(R45) / qTan(RAD(30)), mR * qSin(R45) * invert);
-    QPointF ce = cm + (cb - cm).x() * QPointF(qCos(R60), -qSin(R60) * invert);
-    // line-join indicator's anchor points
-    QPointF jb =
-        c + QPointF(mR * qSin(R45) / qTan(RAD(40)), mR * qSin(R45) * invert);
-    QPointF jm =
-        c + QPointF(mR * qSin(R45) / qTan(RAD(30)), mR * qSin(R45) * invert);
-    QPointF je = jm + (jb - jm).x() * QPointF(qCos(R60), qSin(R60) * invert);
-
-    // 1.2 Add necessary definitions
-    svgDefs += _genSvgDefs(configs, info);
-
-    // 2. Draw the fill/stroke color/style indicator
-    if (has(CBK::fill) || has(CBK::stroke) || has(CBK::strokeDashArray))
-        svgContent += _genColorSvg(configs, info, bl, tr, R);
-
-    // 3. Draw the stroke/fill opacity indicator
-    if (has(CBK::strokeOpacity) || has(CBK::fillOpacity)) {
-        auto [defs, content] = _genOpacitySvg(configs, info, bl, tr, R);
-        svgDefs += defs;
-        svgContent += content;
-    }
-
-    // 4. Draw stroke-width indicator
-    if (has(CBK::strokeWidth))
-        svgContent += _genStrokeWidthSvg(configs, info, stl, str, sR);
+    /// @brief Take the most wanted job out of #pending. Requires #mutex.
+    Job takeNext();
 
-    // 5.1: draw stroke-linecap indicator
-    if (has(CBK::strokeLineCap))
-        svgContent += _genStrokeCapSvg(info, cb, cm, ce);
+    /// @brief Guards all members below
+    QMutex mutex;
+    QVector<Job> pending;
+    QPoint focusPos;
+    /// @brief Number of pool threads running drain()
+    int numDraining = 0;
 
-    // 5.2: draw stroke-linejoin indicator
-    if (has(CBK::strokeLineJoin))
-        svgContent += _genStrokeJoinSvg(info, jb, jm, je);
+    QThreadPool pool;
+};
 
-    // 6. Draw marker start/end/mid indicator
-    if (has(CBK::markerStart) || has(CBK::markerMid) || has(CBK::markerEnd))
-        svgContent += _genMarkerSvg(info, mbl, mbr);
+Panel::IconRenderer::IconRenderer(QObject *parent) : QObject(parent) {}
 
-    // 7. Draw font-style indicator
-    if (has(CBK::fontFamily) || has(CBK::fontStyle))
-        svgContent += _genFontSvg(
-            configs, info, size, size.height() * (orientation ? 0.5 : 0.85));
+Panel::IconRenderer::~IconRenderer() {
+    {
+        QMutexLocker locker(&mutex);
+        pending.clear();
+    }
+    // Renders refer to this
+    pool.waitForDone();
+}
 
-    // 8. Draw font-size indicator
-    if (has(CBK::fontSize))
-        svgContent += _genFontSizeSvg(
-            info, size, size.height() * (orientation ? 0.4 : 0.75));
+Panel::IconRenderer &Panel::IconRenderer::instance() {
+    static QPointer<IconRenderer> renderer;
+    if (!renderer)
+        renderer = new IconRenderer(qApp);
+    return *renderer;
+}
 
-    // Compose final icon
-    return _composeSvg(size, svgDefs, svgContent).toUtf8();
+void Panel::IconRenderer::request(
+    const Panel *owner, QObject *context, const QPoint &pos, bool urgent,
+    const QByteArray &svg, const QSize &size, const Callback &done) {
+    focus();
+    QMutexLocker locker(&mutex);
+    pending.append({owner, context, pos, urgent, svg, size, done});
+    if (numDraining < pool.maxThreadCount()) {
+        ++numDraining;
+        pool.start([this] { drain(); });
+    }
 }
 
-QPixmap
-Panel::drawStyleButtonIcon(quint8 tSlot, quint8 rSlot, quint8 subSlot) const {
-    using Slot = Configs::Slot;
-    using SBInfo = StandardButtonInfo;
-    using CBInfo = CustomButtonInfo;
+void Panel::IconRenderer::cancel(const Panel *owner) {
+    QMutexLocker locker(&mutex);
+    pending.erase(
+        std::remove_if(
+            pending.begin(), pending.end(),
+            [owner](const Job &job) { return job.owner == owner; }),
+        pending.end());
+}
 
-    Slot slot = calcSlot(pSlot, tSlot, rSlot, subSlot);
+void Panel::IconRenderer::focus() {
+    QPoint pos = QCursor::pos();
+    QMutexLocker locker(&mutex);
+    focusPos = pos;
+}
 
-    // Get button to draw icon
-    Button *button = styleButtons[slot].get();
-    // Draw with scaled size, otherwise icon won't scale well
-    QSizeF iconSize = button->inactiveGeometry.size() * button->hoverScale;
+Panel::IconRenderer::Job Panel::IconRenderer::takeNext() {
+    auto rank = [this](const Job &job) {
+        return std::pair(!job.urgent, (job.pos - focusPos).manhattanLength());
+    };
+    auto next = std::min_element(
+        pending.begin(), pending.end(),
+        [&](const Job &a, const Job &b) { return rank(a) < rank(b); });
+    Job job = std::move(*next);
+    pending.erase(next);
+    return job;
+}
 
-    auto render = [&](QByteArray iconSvg) -> QPixmap * {
-        ResvgRenderer renderer(iconSvg, genResvgOptions());
-        if (!renderer.isValid()) {
-            qCritical(
-                "Invalid SVG generated from slot %#x:\n%s", slot,
-                iconSvg.toStdString().c_str());
-            return nullptr;
+void Panel::IconRenderer::drain() {
+    for (;;) {
+        Job job;
+        {
+            QMutexLocker locker(&mutex);
+            if (pending.isEmpty()) {
+                --numDraining;
+                return;
+            }
+            job = takeNext();
         }
 
-        QImage icon = renderer.renderToImage(iconSize.toSize());
-        return new QPixmap(QPixmap::fromImage(icon));
-    };
+        QImage icon = renderIcon(job.svg, job.size);
+        QMetaObject::invokeMethod(
+            this,
+            [job, icon] {
+                if (job.context)
+                    job.done(icon);
+            },
+            Qt::QueuedConnection);
+    }
+}
 
-    QByteArray iconSvg;
+void Panel::drawStyleButtonIcon(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
+    Configs::Slot slot = calcSlot(pSlot, tSlot, rSlot, subSlot);
+    const Configs::ResolvedButton &resolved = configs->getButton(slot);
+    const quint16 index = SlotIndex::local(tSlot, rSlot, subSlot);
+    Button *button = styleButtons[index].get();
+    // The slot may have been emptied since the icon was drawn
+    if (resolved.kind == Configs::SlotKind::None) {
+        for (quint8 state = 0; state < Button::numIconStates; ++state)
+            button->setIconTile(Button::IconState(state), nullptr, {});
+        return;
+    }
+
+    IconFrame frame = _genIconFrame(button);
     // true = pointing up, false = pointing down
     bool orientation = (tSlot + subSlot) % 2;
-    if (configs->hasStandardButton(slot)) {
-        // Cache rendered icons and reuse them if configs not changed.
-        // Stores `{{slot, buttonInfo}, icon}`. The key is used
-        // to test the validity of the buttonInfo associated with `slot`.
-        static QCache<QPair<Slot, SBInfo>, QPixmap> cache(C::iconCacheSize);
-        StandardButtonInfo info = configs->getStandardButton(slot);
+    QByteArray iconSvg;
+    for (quint8 s = 0; s < Button::numIconStates; ++s) {
+        auto state = Button::IconState(s);
+        QSize size = _genIconSize(frame, state, iconDpr);
 
         // Reuse cached icon for speedup
-        if (cache.contains({slot, info}))
-            return *cache[{slot, info}];
-
-        QPixmap *pixmap = render(
-            info.getIconSvg().isEmpty()
-                ? _genStyleButtonSvg(button, *configs, info, orientation)
-                : info.getIconSvg());
-
-        // Cache takes the ownership of pixmap. See QCache document.
-        if (pixmap) {
-            cache.insert({slot, info}, pixmap);
-            return *pixmap;
+        IconKey key = _genStyleIconKey(resolved, size, orientation);
+        if (QImage *icon = iconCache.object(key)) {
+            setStyleButtonIcon(index, state, *icon);
+            continue;
         }
-    } else if (configs->hasCustomButton(slot)) {
-        static QCache<QPair<Slot, CBInfo>, QPixmap> cache(C::iconCacheSize);
-        CustomButtonInfo info = configs->getCustomButton(slot);
-        if (cache.contains({slot, info}))
-            return *cache[{slot, info}];
-
-        QPixmap *pixmap = render(
-            info.getIconSvg().isEmpty()
-                ? _genUnknownStyleSvg(button, orientation)
-                : info.getIconSvg());
-        if (pixmap) {
-            cache.insert({slot, info}, pixmap);
-            return *pixmap;
+
+        QImage painted =
+            _paintStyleIcon(frame, size, *configs, resolved, orientation);
+        if (!painted.isNull()) {
+            iconCache.insert(key, new QImage(painted));
+            setStyleButtonIcon(index, state, painted);
+            continue;
         }
+
+        if (iconSvg.isEmpty())
+            iconSvg = _genStyleIconSvg(frame, *configs, resolved, orientation);
+
+        // Render at the exact size it's shown at, so that it stays sharp
+        quint64 generation = iconGeneration;
+        qreal dpr = iconDpr;
+        IconRenderer::instance().request(
+            this, button, button->mapToGlobal(button->centroid.toPoint()),
+            false, iconSvg, size, [=, this](const QImage &icon) {
+                if (icon.isNull()) {
+                    qCritical(
+                        "Invalid SVG generated from slot %#x:\n%s", slot,
+                        iconSvg.toStdString().c_str());
+                    return;
+                }
+
+                // Don't revive invalidated icons
+                if (generation == iconGeneration
+                    && !iconCache.contains(key))
+                    iconCache.insert(key, _detachIcon(icon));
+                // The button may have been replaced meanwhile, or the panel
+                // moved to a screen of another pixel ratio
+                if (styleButtons[index].get() == button && dpr == iconDpr)
+                    setStyleButtonIcon(index, state, icon);
+            });
     }
-    return QPixmap();
 }
 
-static QByteArray _genCentralButtonSvg(
-    Button *button, const Configs &configs, const StandardButtonInfo &info) {
+void Panel::setStyleButtonIcon(
+    quint16 index, Button::IconState state, const QImage &icon) {
+    const IconAtlasLayout &layout = _genIconAtlasLayout(iconDpr, !parentPanel);
+    if (iconAtlas.isNull()) {
+        iconAtlas = QPixmap(layout.size);
+        iconAtlas.fill(Qt::transparent);
+    }
+
+    // Replace whatever the tile held before. Icons are rendered at the size
+    // of their tile, and buttons don't hold copies of the atlas, so only the
+    // tile is copied.
+    const QRect &tile = layout.tiles[state][index];
+    QPainter painter(&iconAtlas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(tile.topLeft(), icon);
+    painter.end();
+    styleButtons[index]->setIconTile(state, &iconAtlas, tile);
+}
+
+void Panel::updateIconDpr() {
+    qreal dpr = devicePixelRatioF();
+    if (dpr == iconDpr)
+        return;
+    iconDpr = dpr;
+
+    // Tiles are laid out anew for the new size
+    iconAtlas = QPixmap();
+    for (const auto &button : qAsConst(styleButtons))
+        if (button)
+            for (quint8 state = 0; state < Button::numIconStates; ++state)
+                button->setIconTile(Button::IconState(state), nullptr, {});
+
+    // Start over with icons of the new size
+    redrawIcons();
+}
+
+void Panel::redrawIcons() {
+    IconRenderer::instance().cancel(this);
+    drawnIconGeneration = iconGeneration;
+    for (quint8 t = 0; t < 6; ++t)
+        for (quint8 r = 0; r <= 2; ++r)
+            for (quint8 sub = 0; sub <= r * 2; ++sub)
+                if (styleButtons[SlotIndex::local(t, r, sub)])
+                    drawStyleButtonIcon(t, r, sub);
+    if (centralButton)
+        drawCentralButtonIcon();
+}
+
+static IndicatorAnchors
+_genCentralButtonAnchors(const Button *button, const Configs &configs) {
     using C::R30, C::R60, C::R45, C::RAD;
     constexpr qreal R15 = RAD(15);
-    namespace CGK = C::C::G::K;      // button configs Keys
-    namespace CBK = C::C::B::K;      // button configs Keys
     namespace DIS = C::C::G::V::DIS; // default icon style
 
-    // Button *button = styleButtons[slot].get();
-    QSizeF size = button->inactiveGeometry.size() * button->hoverScale;
-    QPointF c = button->centroid * button->hoverScale;
-
-    QString svgDefs;
-    QString svgContent;
+    IndicatorAnchors a;
+    QSizeF size = a.size =
+        button->inactiveGeometry.size() * button->hoverScale;
+    QPointF c = a.c = button->centroid * button->hoverScale;
+    a.questionBaseline = a.fontBaseline = size.height() * 0.675;
+    a.fontSizeBaseline = size.height() * 0.575;
 
-    // 0. Generate a indicator if this is a non-standard style
-    if (info.isEmpty())
-        svgContent += _genQuestionMarkSvg(button, size.height() * 0.675);
-
-    // 1.1 Calculate common anchor points for subsequent drawing
-    auto has = [&](const char *k) -> bool { return info.styles().contains(k); };
-    // color/stroke-width/marker indicator's top/bottom-left/right point
-    QPointF tr, bl, str, stl, mbl, mbr;
     // color/gradient indicator's radius
-    qreal R = size.height() / 3. - C::IC::colorStrokeWidth / 2.;
+    qreal R = a.R = size.height() / 3. - C::IC::colorStrokeWidth / 2.;
     // stroke-width/marker indicator's radius
-    qreal sR = size.height() * 11. / 24., mR = sR;
+    qreal sR = a.sR = size.height() * 11. / 24., mR = sR;
     // qreal mradius = size.height() * 3. / 8.;
     if (configs.defaultIconStyle == DIS::circle) {
-        tr = c + QPointF(R * qCos(R60), -R * qSin(R60));
-        bl = c + QPointF(-R * qCos(R60), R * qSin(R60));
-        str = c + QPointF(sR * qCos(R30), -sR * qSin(R30));
-        stl = c + QPointF(-sR * qCos(R30), -sR * qSin(R30));
-        mbl = c + QPointF(-mR * qCos(R30), mR * qSin(R30));
-        mbr = c + QPointF(mR * qCos(R30), mR * qSin(R30));
+        a.tr = c + QPointF(R * qCos(R60), -R * qSin(R60));
+        a.bl = c + QPointF(-R * qCos(R60), R * qSin(R60));
+        a.str = c + QPointF(sR * qCos(R30), -sR * qSin(R30));
+        a.stl = c + QPointF(-sR * qCos(R30), -sR * qSin(R30));
+        a.mbl = c + QPointF(-mR * qCos(R30), mR * qSin(R30));
+        a.mbr = c + QPointF(mR * qCos(R30), mR * qSin(R30));
     } else if (configs.defaultIconStyle == DIS::square) {
-        tr = c + QPointF(R * qCos(R45), -R * qSin(R45));
-        bl = c + QPointF(-R * qCos(R45), R * qSin(R45));
-        str = c + QPointF(sR * qCos(R45), -sR * qSin(R45));
-        stl = c + QPointF(-sR * qCos(R45), -sR * qSin(R45));
-        mbl = c + QPointF(-mR * qCos(R30), mR * qSin(R30));
-        mbr = c + QPointF(mR * qCos(R30), mR * qSin(R30));
+        a.tr = c + QPointF(R * qCos(R45), -R * qSin(R45));
+        a.bl = c + QPointF(-R * qCos(R45), R * qSin(R45));
+        a.str = c + QPointF(sR * qCos(R45), -sR * qSin(R45));
+        a.stl = c + QPointF(-sR * qCos(R45), -sR * qSin(R45));
+        a.mbl = c + QPointF(-mR * qCos(R30), mR * qSin(R30));
+        a.mbr = c + QPointF(mR * qCos(R30), mR * qSin(R30));
     };
     // line-cap indicator's anchor points
-    QPointF cb =
+    a.cb =
         c + QPointF(-mR * qCos(R30), mR * qCos(R30) / qCos(R15) * qSin(R15));
-    QPointF cm = c + QPointF(-mR, 0);
-    QPointF ce =
+    a.cm = c + QPointF(-mR, 0);
+    a.ce =
         c + QPointF(-mR * qCos(R30), -mR * qCos(R30) / qCos(R15) * qSin(R15));
     // line-join indicator's anchor points
-    QPointF jb =
+    a.jb =
         c + QPointF(mR * qCos(R30), mR * qCos(R30) / qCos(R15) * qSin(R15));
-    QPointF jm = c + QPointF(mR, 0);
-    QPointF je =
+    a.jm = c + QPointF(mR, 0);
+    a.je =
         c + QPointF(mR * qCos(R30), -mR * qCos(R30) / qCos(R15) * qSin(R15));
+    return a;
+}
 
-    // 1.2 Add necessary definitions
-    svgDefs += _genSvgDefs(configs, info);
+/// @brief Pick the styles an indicator is drawn from
+/// @return Those styles, bound to the defs they refer to
+static StandardButtonInfo _genIndicatorInfo(
+    const StandardButtonInfo &info, Indicator indicator,
+    const SvgDefGraph &svgDefs) {
+    StyleRecord styles;
+    QSet<QString> defIds;
+    const quint16 keys = indicatorStyles(indicator);
+    info.styles().forEach([&](StyleRecord::Key key, const QString &value) {
+        if (!(keys & (1u << key)))
+            return;
+        styles.insert(key, value);
+        SvgRefScanner refs(value);
+        for (QStringView id = refs.next(); !id.isEmpty(); id = refs.next())
+            if (QString defId = id.toString(); info.getDefIds().contains(defId))
+                defIds.insert(defId);
+    });
 
-    // 2. Draw the fill/stroke color/style indicator
-    if (has(CBK::fill) || has(CBK::stroke) || has(CBK::strokeDashArray))
-        svgContent += _genColorSvg(configs, info, bl, tr, R);
+    StandardButtonInfo indicatorInfo(defIds, styles, {});
+    indicatorInfo.bindDefs(svgDefs);
+    return indicatorInfo;
+}
 
-    // 3. Draw the stroke/fill opacity indicator
-    if (has(CBK::strokeOpacity) || has(CBK::fillOpacity)) {
-        auto [defs, content] = _genOpacitySvg(configs, info, bl, tr, R);
-        svgDefs += defs;
-        svgContent += content;
+void Panel::drawCentralButtonIcon() {
+    Button *button = centralButton.get();
+    IconFrame frame = _genIconFrame(button);
+    for (quint8 s = 0; s < Button::numIconStates; ++s) {
+        auto state = Button::IconState(s);
+        QSize size = _genIconSize(frame, state, iconDpr);
+        QByteArray iconSvg;
+        centralButtonInfo->accept(ButtonInfoVisitor{
+            [&](StandardButtonInfo &info) {
+                composeCentralButtonIcon(state, size, info);
+            },
+            [&](CustomButtonInfo &info) { iconSvg = info.getIconSvg(); }});
+        if (iconSvg.isEmpty())
+            continue;
+
+        // Don't show the previous styles meanwhile
+        button->setIconTile(state, nullptr, QRect());
+
+        // Render at the exact size it's shown at, so that it stays sharp
+        QSharedPointer<ButtonInfo> info = centralButtonInfo;
+        qreal dpr = iconDpr;
+        IconRenderer::instance().request(
+            this, button, button->mapToGlobal(button->centroid.toPoint()),
+            true, iconSvg, size, [=, this](const QImage &icon) {
+                if (icon.isNull()) {
+                    qCritical(
+                        "Invalid SVG generated from central button:\n%s",
+                        iconSvg.toStdString().c_str());
+                    return;
+                }
+                // Otherwise the icon of newer styles is on its way
+                if (info == centralButtonInfo && dpr == iconDpr) {
+                    centralIcons[state] = QPixmap::fromImage(icon);
+                    button->setIconTile(
+                        state, &centralIcons[state], icon.rect());
+                }
+            });
     }
-
-    // 4. Draw stroke-width indicator
-    if (has(CBK::strokeWidth))
-        svgContent += _genStrokeWidthSvg(configs, info, stl, str, sR);
-
-    // 5.1: draw stroke-linecap indicator
-    if (has(CBK::strokeLineCap))
-        svgContent += _genStrokeCapSvg(info, cb, cm, ce);
-
-    // 5.2: draw stroke-linejoin indicator
-    if (has(CBK::strokeLineJoin))
-        svgContent += _genStrokeJoinSvg(info, jb, jm, je);
-
-    // 6. Draw marker start/end/mid indicator
-    if (has(CBK::markerStart) || has(CBK::markerMid) || has(CBK::markerEnd))
-        svgContent += _genMarkerSvg(info, mbl, mbr);
-
-    // 7. Draw font-style indicator
-    if (has(CBK::fontFamily) || has(CBK::fontStyle))
-        svgContent += _genFontSvg(configs, info, size, size.height() * 0.675);
-
-    // 8. Draw font-size indicator
-    if (has(CBK::fontSize))
-        svgContent += _genFontSizeSvg(info, size, size.height() * 0.575);
-
-    // Compose final icon
-    return _composeSvg(size, svgDefs, svgContent).toUtf8();
 }
 
-QPixmap Panel::drawCentralButtonIcon() const {
-    // Cache rendered icons and reuse them if configs not changed.
-    // Stores `{composed-style-list, icon}`.
-    static QCache<StandardButtonInfo, QPixmap> cachedIcons(C::iconCacheSize);
+void Panel::composeCentralButtonIcon(
+    Button::IconState state, const QSize &size,
+    const StandardButtonInfo &info) {
+    Button *button = centralButton.get();
 
     // Reuse cached icon for speedup
-    QPixmap cachedIcon;
-    bool hasCachedIcon = false;
+    IconKey key{IconKey::CentralButton, info.getFingerprint(), size};
+    if (QImage *icon = iconCache.object(key)) {
+        centralIcons[state] = QPixmap::fromImage(*icon);
+        button->setIconTile(state, &centralIcons[state], icon->rect());
+        return;
+    }
 
-    Button *button = centralButton.get();
-    QByteArray iconSvg;
-    centralButtonInfo->accept(ButtonInfoVisitor{
-        [&](StandardButtonInfo &info) {
-            if (cachedIcons.contains(info)) {
-                cachedIcon = *cachedIcons[info];
-                hasCachedIcon = true;
-            } else {
-                // Redraw icon
-                iconSvg = _genCentralButtonSvg(button, *configs, info);
-            }
-        },
-        [&](CustomButtonInfo &info) { iconSvg = info.getIconSvg(); }});
+    // Indicators collected for the icon
+    struct Layers {
+        std::array<QImage, numIndicators> images;
+        int numPending = 0;
+        // Whether no indicator failed to render
+        bool complete = true;
+    };
+    auto layers = QSharedPointer<Layers>::create();
+    QSharedPointer<ButtonInfo> composed = centralButtonInfo;
+    quint64 generation = iconGeneration;
+    qreal dpr = iconDpr;
+
+    // Stack the indicators the way the svg of the whole style draws them
+    auto compose = [=, this] {
+        QImage icon(size, QImage::Format_ARGB32_Premultiplied);
+        icon.fill(Qt::transparent);
+        QPainter painter(&icon);
+        for (const QImage &image : layers->images)
+            if (!image.isNull())
+                painter.drawImage(0, 0, image);
+        painter.end();
+
+        if (generation == iconGeneration && layers->complete)
+            iconCache.insert(key, new QImage(icon));
+        // Otherwise the icon of newer styles is on its way
+        if (composed == centralButtonInfo && dpr == iconDpr) {
+            centralIcons[state] = QPixmap::fromImage(icon);
+            button->setIconTile(state, &centralIcons[state], icon.rect());
+        }
+    };
 
-    if (hasCachedIcon)
-        return cachedIcon;
+    IndicatorAnchors anchors = _genCentralButtonAnchors(button, *configs);
+    for (int i = 0; i < numIndicators; ++i) {
+        auto indicator = Indicator(i);
+        if (!showsIndicator(info.styles(), indicator))
+            continue;
+
+        // Indicators of styles seen before are reused
+        StandardButtonInfo indicatorInfo =
+            _genIndicatorInfo(info, indicator, configs->getSvgDefGraph());
+        IconKey layerKey{
+            IconKey::CentralLayer, indicatorInfo.getFingerprint(), size,
+            quint8(i)};
+        QImage &image = layers->images[i];
+        if (QImage *cached = iconCache.object(layerKey)) {
+            image = *cached;
+            continue;
+        }
+        image = IndicatorPainter::paint(
+            anchors, size, *configs, indicatorInfo, 1u << i);
+        if (!image.isNull()) {
+            iconCache.insert(layerKey, new QImage(image));
+            continue;
+        }
 
-    // Draw with scaled size, otherwise icon won't scale well
-    QSizeF iconSize = button->inactiveGeometry.size() * button->hoverScale;
+        QByteArray iconSvg =
+            genIndicatorsSvg(anchors, *configs, indicatorInfo, 1u << i);
+        ++layers->numPending;
+        IconRenderer::instance().request(
+            this, button, button->mapToGlobal(button->centroid.toPoint()),
+            true, iconSvg, size, [=, this](const QImage &icon) {
+                if (icon.isNull()) {
+                    qCritical(
+                        "Invalid SVG generated from central button:\n%s",
+                        iconSvg.toStdString().c_str());
+                    layers->complete = false;
+                } else if (generation == iconGeneration) {
+                    // The cache takes the ownership of the icon and might free
+                    // memory immediately.
+                    iconCache.insert(layerKey, _detachIcon(icon));
+                }
+                layers->images[i] = icon;
+                if (--layers->numPending == 0)
+                    compose();
+            });
+    }
 
-    ResvgRenderer renderer(iconSvg, genResvgOptions());
-    if (!renderer.isValid()) {
-        qCritical(
-            "Invalid SVG generated from central button:\n%s",
-            iconSvg.toStdString().c_str());
-        return QPixmap();
+    if (layers->numPending) {
+        // Don't show the previous styles meanwhile
+        button->setIconTile(state, nullptr, QRect());
+    } else {
+        compose();
     }
+}
 
-    QImage icon = renderer.renderToImage(iconSize.toSize());
-    QPixmap pixmap = QPixmap::fromImage(icon);
-    // QCache takes the ownership of pixmap and might free memory immediately.
+void Panel::invalidateIcons() {
+    // Changed styles and defs get new fingerprints, so their icons can't be
+    // looked up anymore and age out of the caches. Only keep icons of the old
+    // styles still being rendered from taking up space.
+    ++iconGeneration;
+}
 
-    centralButtonInfo->accept(ButtonInfoVisitor{
-        [&](StandardButtonInfo &info) {
-            cachedIcons.insert(info, new QPixmap(pixmap));
-        },
-        [&](CustomButtonInfo &) {}});
-    return pixmap;
+void Panel::clearIcons() {
+    ++iconGeneration;
+    iconCache.logStats("cleared");
+    iconCache.clear();
+}
+
+void Panel::setIconCacheBudget(quint32 megabytes) {
+    iconCache.setBudget(qint64(megabytes) << 20);
+}
+
+void Panel::enableIconDiskCache(const QString &cachePath) {
+    iconDiskCache = std::make_unique<IconDiskCache>(cachePath);
 }
 
 bool Panel::isActive() const {
@@ -713,16 +849,62 @@ Panel::calcSlot(quint8 pSlot, quint8 tSlot, quint8 rSlot, quint8 subSlot) {
            | quint32(subSlot);
 }
 
+QImage Panel::renderIcon(const QByteArray &svg, const QSize &size) {
+    // Identifies the options set in genResvgOptions()
+    static const QByteArray resvgOptionsKey = "system-fonts;optimize-quality";
+
+    QByteArray key;
+    if (iconDiskCache) {
+        key = IconDiskCache::genKey(svg, size, resvgOptionsKey);
+        if (QImage icon = iconDiskCache->load(key); !icon.isNull())
+            return icon;
+    }
+
+    ResvgRenderer renderer(svg, genResvgOptions());
+    if (!renderer.isValid())
+        return QImage();
+    QImage icon = renderer.renderToImage(size);
+    if (iconDiskCache && !icon.isNull())
+        iconDiskCache->save(key, icon);
+    return icon;
+}
+
+/// @brief Create resvg options with all system fonts loaded
+/// @param cachePath Where the font index is kept. If empty, resvg looks for
+/// the fonts itself.
+static std::shared_ptr<ResvgOptions>
+_createResvgOptions(const QString &cachePath) {
+    QElapsedTimer timer;
+    timer.start();
+    auto options = std::make_shared<ResvgOptions>();
+    if (cachePath.isEmpty())
+        options->loadSystemFonts();
+    else
+        for (const QString &font : FontIndex(cachePath).files())
+            options->loadFontFile(font);
+    options->setImageRenderingMode(
+        resvg_image_rendering::RESVG_IMAGE_RENDERING_OPTIMIZE_QUALITY);
+    qDebug("Fonts loaded in %lld ms", timer.elapsed());
+    return options;
+}
+
+/// @brief resvg options being created by Panel::loadFontsAsync()
+static std::shared_future<std::shared_ptr<ResvgOptions>> pendingResvgOptions;
+
+void Panel::loadFontsAsync(const QString &cachePath) {
+    Q_ASSERT(!pendingResvgOptions.valid());
+    pendingResvgOptions =
+        std::async(std::launch::async, _createResvgOptions, cachePath).share();
+}
+
 const ResvgOptions &Panel::genResvgOptions() {
     // Qt's svg is too weak. It cannot render clip/pattern. we use resvg here.
-    static std::unique_ptr<ResvgOptions> resvgOptions;
-    // Cache resvgOptions to reduce system font loading time
-    if (!resvgOptions) {
-        resvgOptions = std::make_unique<ResvgOptions>();
-        resvgOptions->loadSystemFonts();
-        resvgOptions->setImageRenderingMode(
-            resvg_image_rendering::RESVG_IMAGE_RENDERING_OPTIMIZE_QUALITY);
-    }
+    // Cache resvgOptions to reduce system font loading time. Initialized
+    // once even if icons are rendered on several threads, waiting for
+    // loadFontsAsync() if it was called.
+    static const std::shared_ptr<ResvgOptions> resvgOptions =
+        pendingResvgOptions.valid() ? pendingResvgOptions.get()
+                                    : _createResvgOptions({});
     return *resvgOptions;
 }
 
@@ -778,70 +960,154 @@ QVector<QPointF> Panel::genBorderButtonMask(quint8 tSlot) {
 
 QVector<QPointF>
 Panel::genStyleButtonMask(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
-    using C::R30, C::R60;
+    return _genStyleButtonVertices(
+        size(), unitLen, gapLen, tSlot, rSlot, subSlot);
+}
 
-    // Upper half of the hexagon:
-    /*
-    **       •---•---•---•
-    **      / \ / \ / \ / \
-    **     •---•---•---•---•
-    **    / \ / \ / \ / \ / \
-    **   •---•---•---•---2---3
-    **  / \ / \ / \ / \ / \ / \
-    ** •---•---•---C-->•-->1-->2
-    */
-    // -->: the tSlot direction
-    // C: center of the hexagon
-    // •: triangle vertices
-    // 1: the 1st point
-    // 2: the 2nd point
-    // 3: the 3rd point
+/// @brief Renders icons of style buttons ahead of time
+/// @details Slots are visited on the GUI thread in small batches, lower
+/// panels first, since generating their svgs reads the configs. The svgs are
+/// rendered on idle-priority threads, and the icons go to the disk cache, as
+/// well as to the memory cache while it has room. Warming up stops once
+/// Configs::warmUpBudgetMs is used up.
+class Panel::IconWarmUp : public QObject {
+public:
+    IconWarmUp(const QSharedPointer<Configs> &configs, QObject *parent);
+    ~IconWarmUp() override;
+
+private:
+    /// @brief Hand the svgs of the next few slots to #pool
+    void prepareBatch();
+
+    /// @brief Store a rendered icon, on the GUI thread
+    void finish(const IconKey &key, const QImage &icon, quint64 generation);
+
+    /// @brief Delete this once all renders are done
+    void deleteIfDone();
+
+    const QSharedPointer<Configs> configs;
+    /// @brief Device pixel ratio to render for, that of the primary screen
+    const qreal dpr;
+    /// @brief Slots to visit, and the next one to visit
+    QVector<Configs::Slot> pending;
+    qsizetype next = 0;
+    /// @brief Number of renders handed to #pool and not yet finished
+    qsizetype numRendering = 0;
+    qsizetype numRendered = 0;
+
+    QDeadlineTimer deadline;
+    QElapsedTimer timer;
+    QThreadPool pool;
+};
+
+Panel::IconWarmUp::IconWarmUp(
+    const QSharedPointer<Configs> &configs, QObject *parent)
+    : QObject(parent), configs(configs),
+      dpr(QGuiApplication::primaryScreen()->devicePixelRatio()),
+      pending(configs->buttonSlots()),
+      deadline(
+          configs->warmUpBudgetMs
+              ? QDeadlineTimer(qint64(configs->warmUpBudgetMs))
+              : QDeadlineTimer(QDeadlineTimer::Forever)) {
+    timer.start();
+    pool.setMaxThreadCount(int(configs->warmUpThreads));
+
+    // The pSlot is the highest byte, so this puts lower panels first
+    std::sort(pending.begin(), pending.end());
+
+    QTimer::singleShot(0, this, [this] { prepareBatch(); });
+}
 
-    // Vertex of the triangular button (coordinates relative to panel)
-    return {
-        {
-            // The 1st point
-            size().width() / 2.
-                // Base x
-                + ((rSlot * qCos(tSlot * R60)
-                    + (subSlot / 2) * qCos((tSlot + 2) * R60))
-                       * unitLen / 3.
-                   // Offset for border
-                   + gapLen * qCos((tSlot + 0.5 + (subSlot % 2)) * R60)),
-            size().height() / 2.
-                // Base y
-                - ((rSlot * qSin(tSlot * R60)
-                    + (subSlot / 2) * qSin((tSlot + 2) * R60))
-                       * unitLen / 3.
-                   // Offset for border
-                   + gapLen * qSin((tSlot + 0.5 + (subSlot % 2)) * R60)),
-        },
-        {
-            // The 2nd point
-            size().width() / 2.
-                + (((rSlot + 1 - (subSlot % 2)) * qCos(tSlot * R60)
-                    + ((subSlot + 1) / 2) * qCos((tSlot + 2) * R60))
-                       * unitLen / 3.
-                   + gapLen * qCos((tSlot + 2.5 - (subSlot % 2) * 3) * R60)),
-            size().height() / 2.
-                - (((rSlot + 1 - (subSlot % 2)) * qSin(tSlot * R60)
-                    + ((subSlot + 1) / 2) * qSin((tSlot + 2) * R60))
-                       * unitLen / 3.
-                   + gapLen * qSin((tSlot + 2.5 - (subSlot % 2) * 3) * R60)),
-        },
-        {
-            // The 3rd point
-            size().width() / 2.
-                + (((rSlot + 1) * qCos(tSlot * R60)
-                    + (subSlot / 2 + 1) * qCos((tSlot + 2) * R60))
-                       * unitLen / 3.
-                   + gapLen * qCos((tSlot - 1.5 - (subSlot % 2)) * R60)),
-            size().height() / 2.
-                - (((rSlot + 1) * qSin(tSlot * R60)
-                    + (subSlot / 2 + 1) * qSin((tSlot + 2) * R60))
-                       * unitLen / 3.
-                   + gapLen * qSin((tSlot - 1.5 - (subSlot % 2)) * R60)),
-        }};
+Panel::IconWarmUp::~IconWarmUp() {
+    // Renders refer to this
+    pool.clear();
+    pool.waitForDone();
+}
+
+void Panel::IconWarmUp::prepareBatch() {
+    int numPrepared = 0;
+    for (; next < pending.size() && numPrepared < C::warmUpBatchSize; ++next) {
+        if (deadline.hasExpired()) {
+            next = pending.size();
+            break;
+        }
+
+        Configs::Slot slot = pending[next];
+        quint8 p = slot >> 24, t = slot >> 16, r = slot >> 8, sub = slot;
+        // Skip slots no panel shows, or already drawn
+        const Configs::ResolvedButton &resolved = configs->getButton(slot);
+        if ((p == 0 && r == 0) || p > configs->panelMaxLevels * 6
+            || resolved.kind == Configs::SlotKind::None)
+            continue;
+
+        const IconFrame &frame =
+            _genIconFrames()[SlotIndex::local(t, r, sub)];
+        bool orientation = (t + sub) % 2;
+        quint64 generation = iconGeneration;
+        QByteArray svg;
+        for (quint8 state = 0; state < Button::numIconStates; ++state) {
+            QSize size = _genIconSize(frame, Button::IconState(state), dpr);
+            IconKey key = _genStyleIconKey(resolved, size, orientation);
+            if (iconCache.contains(key))
+                continue;
+
+            ++numRendering;
+            ++numPrepared;
+            QImage painted = _paintStyleIcon(
+                frame, size, *configs, resolved, orientation);
+            if (!painted.isNull()) {
+                finish(key, painted, generation);
+                continue;
+            }
+
+            if (svg.isEmpty())
+                svg = _genStyleIconSvg(frame, *configs, resolved, orientation);
+            pool.start([=, this] {
+                QThread::currentThread()->setPriority(QThread::IdlePriority);
+                QImage icon;
+                if (!deadline.hasExpired())
+                    icon = renderIcon(svg, size);
+                QMetaObject::invokeMethod(
+                    this,
+                    [=, this] { finish(key, icon, generation); },
+                    Qt::QueuedConnection);
+            });
+        }
+    }
+
+    if (next < pending.size())
+        QTimer::singleShot(0, this, [this] { prepareBatch(); });
+    else
+        deleteIfDone();
+}
+
+void Panel::IconWarmUp::finish(
+    const IconKey &key, const QImage &icon, quint64 generation) {
+    --numRendering;
+    // Don't evict icons that are in use, nor revive invalidated ones
+    if (!icon.isNull()) {
+        ++numRendered;
+        if (generation == iconGeneration && !iconCache.contains(key)
+            && iconCache.hasRoom(icon))
+            iconCache.insert(key, _detachIcon(icon));
+    }
+    deleteIfDone();
+}
+
+void Panel::IconWarmUp::deleteIfDone() {
+    if (next < pending.size() || numRendering)
+        return;
+    qDebug(
+        "Icon warm-up rendered %lld icons of %lld buttons in %lld ms",
+        qlonglong(numRendered), qlonglong(pending.size()),
+        qlonglong(timer.elapsed()));
+    iconCache.logStats("after warm-up");
+    deleteLater();
+}
+
+void Panel::warmUpIcons(const QSharedPointer<Configs> &configs) {
+    if (configs->warmUpThreads)
+        new IconWarmUp(configs, qApp);
 }
 
 QVector<QPointF> Panel::genCentralButtonMask() {
@@ -865,9 +1131,8 @@ Panel::Panel(
       coordinate(parent ? parent->calcRelativeCoordinate(tSlot) : QPoint{0, 0}),
       pSlot(parent ? parent->parentPanel ? parent->pSlot + 6 : tSlot + 1 : 0),
       parentPanel(parent), tSlot(tSlot), childPanels(6, nullptr),
-      borderButtons(6, nullptr), hoverScale(1.5), unitLen(200), gapLen(3) {
-    using C::R60;
-
+      borderButtons(6, nullptr), hoverScale(C::PG::hoverScale),
+      unitLen(C::PG::unitLen), gapLen(C::PG::gapLen) {
     // Preconditions
     Q_ASSERT_X(this->configs, __func__, "Configs not initialized");
     Q_ASSERT_X(this->_pGrid, __func__, "Panel grid not initialized");
@@ -882,18 +1147,16 @@ Panel::Panel(
     panelGrid[coordinate] = this;
 
     // Set window location and size to be the bounding box of the hexagon
-    setFixedSize(
-        int(unitLen * (2 + 2 / 3.)), int(unitLen * qSin(R60) * (2 + 2 / 3.)));
-
-    // Show before move to allow creating a window outside the screen
-    show();
+    setFixedSize(_genPanelSize(unitLen));
 
-    if (parentPanel)
+    // Child panels open at once, the root panel waits for popUp(). Show
+    // before move to allow creating a window outside the screen.
+    if (parentPanel) {
+        show();
         move(parentPanel->calcRelativePanelPos(tSlot));
-    else {
-        QPoint center(geometry().width() / 2, geometry().height() / 2);
-        move(QCursor::pos() - center);
     }
+    iconDpr = devicePixelRatioF();
+    drawnIconGeneration = iconGeneration;
 
     // Add style buttons
     for (quint8 i = 0; i < 6; ++i)
@@ -909,6 +1172,40 @@ Panel::Panel(
     updateMask();
 }
 
+void Panel::reset() {
+    Q_ASSERT(!parentPanel);
+    hide();
+    QToolTip::hideText();
+
+    // Child panels give their border buttons back on closing
+    childPanels.fill(nullptr);
+
+    // Forget the styles picked
+    for (const auto &button : qAsConst(styleButtons))
+        if (button)
+            button->reset();
+    activeButtons = ActiveButtons();
+    centralButtonInfo = nullptr;
+    centralButton = nullptr;
+    update();
+
+    // Configs reloaded meanwhile may have changed any button
+    if (drawnIconGeneration != iconGeneration)
+        redrawIcons();
+    iconCache.logStats("after closing panels");
+}
+
+void Panel::popUp() {
+    // Configs may have been reloaded while hidden
+    if (drawnIconGeneration != iconGeneration)
+        redrawIcons();
+    // Show before move to allow placing the window outside the screen
+    show();
+    QPoint center(geometry().width() / 2, geometry().height() / 2);
+    move(QCursor::pos() - center);
+    raise();
+}
+
 void Panel::updateMask() {
     using C::R60;
     // Generate the center hexagon
@@ -956,14 +1253,11 @@ Button *Panel::addStyleButton(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
             geometry, mask, hoverScale, centroid - geometry.topLeft(), this,
             configs->buttonBgColorInactive, configs->buttonBgColorActive),
         [](Button *b) { b->deleteLater(); });
-    styleButtons.insert(slot, button);
+    const quint16 index = SlotIndex::local(tSlot, rSlot, subSlot);
+    styleButtons[index] = button;
 
-    // Draw icon on the button
-    if (configs->hasButton(slot)) {
-        // Draw and set icon for this button
-        button->setIcon(drawStyleButtonIcon(tSlot, rSlot, subSlot));
-        button->setIconSize(button->geometry().size());
-    }
+    // Draw icon on the button, it shows up blank until rendered
+    drawStyleButtonIcon(tSlot, rSlot, subSlot);
     button->show();
 
     Button *rawButton = button.get();
@@ -989,11 +1283,11 @@ Button *Panel::addStyleButton(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
 
     for (Panel *panel = this; panel; panel = panel->parentPanel) {
         // Set composed styles and central icons
-        auto updateStyles = [this, slot, panel] {
+        auto updateStyles = [this, slot, index, panel] {
             // Don't smart pointer here, otherwise will cause smart pointer
             // loop
-            auto action = (this->styleButtons[slot]->isActive()
-                           || this->styleButtons[slot]->isHovering())
+            auto action = (this->styleButtons[index]->isActive()
+                           || this->styleButtons[index]->isHovering())
                               ? &ActiveButtons::insert
                               : &ActiveButtons::remove;
             // Update styles and central icon of all parent panels
@@ -1011,13 +1305,11 @@ Button *Panel::addStyleButton(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
 }
 
 void Panel::delStyleButton(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
-    Configs::Slot slot = calcSlot(pSlot, tSlot, rSlot, subSlot);
-    if (styleButtons.contains(slot)) {
-        if (styleButtons[slot]) {
-            styleButtons[slot]->disconnect();
-            styleButtons[slot] = nullptr;
-        }
-        styleButtons.remove(slot);
+    const quint16 index = SlotIndex::local(tSlot, rSlot, subSlot);
+    QSharedPointer<Button> &button = styleButtons[index];
+    if (button) {
+        button->disconnect();
+        button = nullptr;
     }
 }
 
@@ -1081,15 +1373,16 @@ void Panel::updateCentralButton() {
     }
 
     // Draw and set icon for this button
-    centralButton->setIcon(drawCentralButtonIcon());
-    centralButton->setIconSize(centralButton->geometry().size());
+    drawCentralButtonIcon();
 
     // Set tooltip for this button
     centralButtonInfo->accept(ButtonInfoVisitor{
         [&](const StandardButtonInfo &bi) {
             QStringList styles;
-            for (const QString &key : bi.styles().keys())
-                styles.append(key + ": " + bi.styles().value(key));
+            bi.styles().forEach(
+                [&](StyleRecord::Key key, const QString &value) {
+                    styles.append(StyleRecord::name(key) + (": " + value));
+                });
             centralButton->setToolTip(styles.join('\n'));
         },
         [&](const CustomButtonInfo &bi) {
@@ -1113,19 +1406,25 @@ void Panel::composeCentralButtonInfo() {
     QSharedPointer<StandardButtonInfo> standardButton(new StandardButtonInfo);
     QSharedPointer<CustomButtonInfo> customButton(new CustomButtonInfo);
 
-    for (const Configs::Slot &slot : activeButtons.orderedList())
-        if (isStandardStyle && configs->hasStandardButton(slot)) {
-            *standardButton += configs->getStandardButton(slot);
-        } else if (configs->hasCustomButton(slot)) {
-            *customButton += configs->getCustomButton(slot);
+    for (const Configs::Slot &slot : activeButtons.orderedList()) {
+        const Configs::ResolvedButton &button = configs->getButton(slot);
+        if (isStandardStyle && button.kind == Configs::SlotKind::Standard) {
+            *standardButton += button.standard();
+        } else if (button.kind == Configs::SlotKind::Custom) {
+            *customButton += button.custom();
             isStandardStyle = false;
         }
+    }
 
     isStandardStyle ? (centralButtonInfo = standardButton)
                     : (centralButtonInfo = customButton);
+    centralButtonInfo->bindDefs(configs->getSvgDefGraph());
 }
 
 void Panel::moveEvent(QMoveEvent *event) {
+    // The panel may have moved to another screen
+    updateIconDpr();
+
     // Prevent infinite recursion.
     if (pos() == event->pos())
         return;
@@ -1144,6 +1443,9 @@ void Panel::closeEvent(QCloseEvent *e) {
     // Unregister from panelGrid first to avoid subsequent neigbor processing
     panelGrid.remove(coordinate);
 
+    // Icons not rendered yet are no longer needed
+    IconRenderer::instance().cancel(this);
+
     // Disconnect all buttons to prevent subsequent unwanted events
     for (const auto &button : qAsConst(styleButtons))
         if (button)
@@ -1211,6 +1513,9 @@ void Panel::paintEvent(QPaintEvent *) {
 }
 
 void Panel::enterEvent(QEvent *e) {
+    // Render icons of this panel before those of the others
+    IconRenderer::instance().focus();
+
     // Close all inactive child panels
     for (int tSlot = 0; tSlot < childPanels.size(); ++tSlot)
         if (childPanels[tSlot]) {
@@ -1265,7 +1570,7 @@ void Panel::copyStyle() {
         QMimeData *styleSvg = new QMimeData;
         styleSvg->setData(
             C::styleMimeType,
-            centralButtonInfo->genStyleSvg(configs->getSvgDefs()));
+            centralButtonInfo->genStyleSvg(configs->getSvgDefGraph()));
         QApplication::clipboard()->setMimeData(styleSvg);
         qDebug() << "Style copied " << styleSvg->data(C::styleMimeType);
     } else {
@@ -1316,7 +1621,7 @@ QList<Configs::Slot> Panel::ActiveButtons::orderedList() const {
         return {};
 
     QList<Configs::Slot> result;
-    for (Configs::Slot cur = head; cur != tail; cur = list[cur].second)
+    for (Configs::Slot cur = head; cur != tail; cur = list.find(cur)->second)
         result.append(cur);
     result.append(tail);
     return result;
@@ -13,16 +13,59 @@
 #include <QWeakPointer>
 #include <QWidget>
 #include <ResvgQt.h>
+#include <array>
 #include <memory>
 
 /// @brief A Panel is a hexagon that contains multiple buttons.
 class Panel : public QWidget {
     Q_OBJECT
 public:
+    /// @details Child panels show up at once, next to their parent. The root
+    /// panel stays hidden until popUp().
     Panel(
         Panel *parent = nullptr, quint8 tSlot = 0,
         const QSharedPointer<Configs> &configs = nullptr);
 
+    /// @brief Tell that icons of any buttons may be outdated
+    /// @details Cached icons are keyed by the fingerprints of their styles,
+    /// which change along with the styles and defs. So nothing needs to be
+    /// dropped, this only keeps icons being rendered from being cached.
+    static void invalidateIcons();
+
+    /// @brief Drop all cached icons
+    static void clearIcons();
+
+    /// @brief Set the memory to keep rendered icons in
+    /// @details Style button icons, central button icons and their layers
+    /// share it, the least recently used ones are dropped beyond it.
+    static void setIconCacheBudget(quint32 megabytes);
+
+    /// @brief Keep rendered icons on disk, so that later runs start warm
+    /// @param cachePath The directory to store the icons in
+    static void enableIconDiskCache(const QString &cachePath);
+
+    /// @brief Start loading the fonts used to render icons in the background
+    /// @details Call it once, early, so that the first icons don't wait for
+    /// the fonts. The list of font files is kept in a FontIndex.
+    /// @param cachePath The directory to store the font index in
+    static void loadFontsAsync(const QString &cachePath);
+
+    /// @brief Render the icons of all configured buttons in the background,
+    /// so that opening panels doesn't have to
+    /// @details Uses Configs::warmUpThreads idle-priority threads for at most
+    /// Configs::warmUpBudgetMs. Does nothing if the former is 0.
+    static void warmUpIcons(const QSharedPointer<Configs> &configs);
+
+    /// @brief Hide the root panel and bring it back to how it was built, so
+    /// that it can pop up again instead of building a new one
+    /// @details Closes the child panels, deactivates all buttons and drops
+    /// the central button. Icons are kept, and redrawn if configs changed.
+    /// popUp() redraws them too, for changes made while hidden.
+    void reset();
+
+    /// @brief Show the root panel centered at the cursor
+    void popUp();
+
 public slots:
     void copyStyle();
 
@@ -103,10 +146,36 @@ private:
 
     QVector<QPointF> genCentralButtonMask();
 
-    QPixmap
-    drawStyleButtonIcon(quint8 tSlot, quint8 rSlot, quint8 subSlot) const;
-
-    QPixmap drawCentralButtonIcon() const;
+    /// @brief Set the icons of a style button
+    /// @details There is an icon for each Button::IconState, rendered at the
+    /// exact size in device pixels the button shows it at. Cached icons are
+    /// set right away. Otherwise the button is left blank until IconRenderer
+    /// hands the icon over.
+    void drawStyleButtonIcon(quint8 tSlot, quint8 rSlot, quint8 subSlot);
+
+    /// @brief Set the icons of the central button, see drawStyleButtonIcon()
+    void drawCentralButtonIcon();
+
+    /// @brief Set an icon of the central button showing standard styles
+    /// @details The icon is composited from an image of each indicator, so
+    /// that indicators of styles shown before are reused, and only the
+    /// others are drawn.
+    /// @param size Size of the icon in device pixels
+    void composeCentralButtonIcon(
+        Button::IconState state, const QSize &size,
+        const StandardButtonInfo &info);
+
+    /// @brief Paint an icon of a style button into its tile of #iconAtlas
+    /// @param index SlotIndex::local() of the button
+    void setStyleButtonIcon(
+        quint16 index, Button::IconState state, const QImage &icon);
+
+    /// @brief Redraw all icons if the panel is now on a screen of another
+    /// device pixel ratio
+    void updateIconDpr();
+
+    /// @brief Drop the icons shown and draw them again
+    void redrawIcons();
 
     /// @brief Tells whether this panel is currently active.
     /// @details A panel is active if one of its button is active, or one of
@@ -120,6 +189,14 @@ private:
     static Configs::Slot
     calcSlot(quint8 pSlot, quint8 tSlot, quint8 rSlot, quint8 subSlot);
 
+    class IconRenderer;
+    class IconWarmUp;
+
+    /// @brief Render an icon with resvg, or load it from the disk cache
+    /// @note Thread-safe
+    /// @return The icon, or a null image if the svg is invalid
+    static QImage renderIcon(const QByteArray &svg, const QSize &size);
+
     /// @brief Generate options to pass to resvg renderer.
     /// @return The returned optios should not be copied.
     static const ResvgOptions &genResvgOptions();
@@ -175,8 +252,21 @@ private:
     /// @brief Children panels of this panel
     QVector<QSharedPointer<Panel>> childPanels;
 
-    /// @brief Style buttons, mapped to corresponding slot
-    QHash<Configs::Slot, QSharedPointer<Button>> styleButtons;
+    /// @brief Style buttons of this panel, indexed by SlotIndex::local()
+    std::array<QSharedPointer<Button>, SlotIndex::perPanel> styleButtons;
+
+    /// @brief Icons of all style buttons, packed in one pixmap
+    /// @details Icons are painted into their tile as they become available.
+    /// All style buttons draw their part of it.
+    QPixmap iconAtlas;
+    /// @brief Icons of the central button, indexed by Button::IconState
+    std::array<QPixmap, Button::numIconStates> centralIcons;
+    /// @brief Device pixel ratio the icons are rendered for
+    qreal iconDpr = 1;
+    /// @brief The icon generation (see Panel::invalidateIcons()) the icons
+    /// shown were drawn in. Shown icons are only redrawn by reset() and
+    /// popUp().
+    quint64 drawnIconGeneration = 0;
 
     /// @brief Border buttons of this panel, for expanding children panels
     QVector<QSharedPointer<HiddenButton>> borderButtons;
@@ -216,7 +306,7 @@ private:
         /// @details O(1) time for insert and remove while maintaining order.
         /// * If `prev == cur`, then `cur` is head
         /// * If `next == cur`, then `cur` is tail
-        QHash<Configs::Slot, QPair<Configs::Slot, Configs::Slot>> list;
+        SlotMap<QPair<Configs::Slot, Configs::Slot>> list;
         /// @brief First active button in the deque.
         /// @details If list is empty, this value is meaningless.
         Configs::Slot head;
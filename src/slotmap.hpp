@@ -0,0 +1,187 @@
+#ifndef SLOTMAP_HPP
+#define SLOTMAP_HPP
+
+#include <QDataStream>
+#include <QVector>
+#include <QtGlobal>
+
+/// @brief A bijection between valid slots and a dense 16-bit index.
+/// @details A slot is encoded as `0xPPTTRRSS`. Within a panel there are 6
+/// tSlots, each has rSlot 0~2 with `rSlot * 2 + 1` subSlots, i.e. 9 buttons
+/// per tSlot and 54 per panel. Since pSlot is 8 bits wide, all slots fit in
+/// `256 * 54` indices.
+namespace SlotIndex {
+
+/// @brief Number of buttons of a tSlot
+constexpr quint16 perTSlot = 1 + 3 + 5;
+/// @brief Number of buttons of a panel
+constexpr quint16 perPanel = 6 * perTSlot;
+/// @brief Number of distinct indices
+constexpr quint32 count = 256 * perPanel;
+
+/// @brief Tell whether the t/r/subSlot part of a slot is in range
+constexpr bool isValid(quint32 slot) {
+    quint8 t = (slot >> 16) & 0xff, r = (slot >> 8) & 0xff, sub = slot & 0xff;
+    return t < 6 && r < 3 && sub <= r * 2;
+}
+
+/// @brief Index of a button within its panel, 0~(#perPanel-1)
+/// @details rSlot r starts at offset r², since there are `2r - 1` buttons
+/// in the rSlot before it.
+constexpr quint16 local(quint8 tSlot, quint8 rSlot, quint8 subSlot) {
+    return tSlot * perTSlot + rSlot * rSlot + subSlot;
+}
+
+/// @brief Index of a valid slot, 0~(#count-1)
+constexpr quint16 of(quint32 slot) {
+    return ((slot >> 24) & 0xff) * perPanel
+           + local((slot >> 16) & 0xff, (slot >> 8) & 0xff, slot & 0xff);
+}
+
+/// @brief The slot at an index, inverse of of()
+constexpr quint32 slotAt(quint16 index) {
+    quint32 p = index / perPanel, t = index % perPanel / perTSlot;
+    quint32 k = index % perTSlot, r = k < 1 ? 0 : k < 4 ? 1 : 2;
+    return p << 24 | t << 16 | r << 8 | (k - r * r);
+}
+
+static_assert(count <= 0xffff);
+static_assert(of(0xff050204) == count - 1 && slotAt(count - 1) == 0xff050204);
+static_assert(slotAt(of(0x07030102)) == 0x07030102);
+
+} // namespace SlotIndex
+
+/// @brief A map from slots to values, backed by flat arrays.
+/// @details Values are stored contiguously in insertion order. A table
+/// indexed by SlotIndex::of() maps each slot to its position, so lookups cost
+/// two array accesses and no hashing. The table only grows up to the largest
+/// index inserted. Removal moves the last entry into the hole, so it's O(1)
+/// but doesn't preserve order.
+template <typename T> class SlotMap {
+public:
+    bool contains(quint32 slot) const {
+        return position(slot) != npos;
+    }
+
+    /// @return The value of the slot, or nullptr if absent. The pointer is
+    /// invalidated by any modification.
+    const T *find(quint32 slot) const {
+        quint16 pos = position(slot);
+        return pos == npos ? nullptr : &entries[pos];
+    }
+
+    T value(quint32 slot, const T &defaultValue = T()) const {
+        const T *entry = find(slot);
+        return entry ? *entry : defaultValue;
+    }
+
+    /// @brief Get the value of the slot, inserting a default one if absent
+    T &operator[](quint32 slot) {
+        quint16 pos = position(slot);
+        if (pos == npos) {
+            insert(slot, T());
+            pos = entries.size() - 1;
+        }
+        return entries[pos];
+    }
+
+    void insert(quint32 slot, const T &value) {
+        Q_ASSERT(SlotIndex::isValid(slot));
+        quint16 index = SlotIndex::of(slot);
+        if (index >= positions.size())
+            positions.append(
+                QVector<quint16>(index + 1 - positions.size(), npos));
+
+        if (positions[index] != npos) {
+            entries[positions[index]] = value;
+            return;
+        }
+        positions[index] = entries.size();
+        slotKeys.append(slot);
+        entries.append(value);
+    }
+
+    /// @return Whether the slot was present
+    bool remove(quint32 slot) {
+        quint16 pos = position(slot);
+        if (pos == npos)
+            return false;
+
+        positions[SlotIndex::of(slot)] = npos;
+        if (pos != entries.size() - 1) {
+            slotKeys[pos] = slotKeys.last();
+            entries[pos] = std::move(entries.last());
+            positions[SlotIndex::of(slotKeys[pos])] = pos;
+        }
+        slotKeys.removeLast();
+        entries.removeLast();
+        return true;
+    }
+
+    void clear() {
+        positions.clear();
+        slotKeys.clear();
+        entries.clear();
+    }
+
+    qsizetype size() const {
+        return entries.size();
+    }
+
+    bool isEmpty() const {
+        return entries.isEmpty();
+    }
+
+    /// @brief Slots of all entries, in the same order as values()
+    const QVector<quint32> &keys() const {
+        return slotKeys;
+    }
+
+    const QVector<T> &values() const {
+        return entries;
+    }
+
+    friend QDataStream &operator<<(QDataStream &out, const SlotMap &map) {
+        return out << map.slotKeys << map.entries;
+    }
+
+    friend QDataStream &operator>>(QDataStream &in, SlotMap &map) {
+        QVector<quint32> slotKeys;
+        QVector<T> entries;
+        in >> slotKeys >> entries;
+
+        map.clear();
+        if (slotKeys.size() != entries.size()) {
+            in.setStatus(QDataStream::ReadCorruptData);
+            return in;
+        }
+        for (qsizetype i = 0; i < slotKeys.size(); ++i) {
+            if (!SlotIndex::isValid(slotKeys[i])) {
+                in.setStatus(QDataStream::ReadCorruptData);
+                map.clear();
+                return in;
+            }
+            map.insert(slotKeys[i], entries[i]);
+        }
+        return in;
+    }
+
+private:
+    static constexpr quint16 npos = 0xffff;
+
+    /// @brief Position in #entries of a slot, or #npos if absent
+    quint16 position(quint32 slot) const {
+        if (!SlotIndex::isValid(slot))
+            return npos;
+        quint16 index = SlotIndex::of(slot);
+        return index < positions.size() ? positions[index] : npos;
+    }
+
+    /// @brief Positions in #entries, indexed by SlotIndex::of()
+    QVector<quint16> positions;
+    /// @brief Slots of #entries
+    QVector<quint32> slotKeys;
+    QVector<T> entries;
+};
+
+#endif // SLOTMAP_HPP
@@ -0,0 +1,81 @@
+#include "stylerecord.hpp"
+
+#include "constants.hpp"
+
+#include <QHash>
+#include <iterator>
+
+namespace BK = C::C::B::K;
+static_assert(std::size(BK::basicStyles) == StyleRecord::numKeys);
+
+const char *StyleRecord::name(Key key) {
+    return BK::basicStyles[key];
+}
+
+std::optional<StyleRecord::Key> StyleRecord::keyOf(const QString &name) {
+    for (int key = 0; key < numKeys; ++key)
+        if (name == QLatin1String(BK::basicStyles[key]))
+            return Key(key);
+    return std::nullopt;
+}
+
+void StyleRecord::insert(Key key, const QString &value) {
+    presence |= 1u << key;
+    values[key] = value;
+}
+
+void StyleRecord::remove(Key key) {
+    presence &= ~(1u << key);
+    values[key].clear();
+}
+
+void StyleRecord::clear() {
+    forEach([this](Key key, const QString &) { values[key].clear(); });
+    presence = 0;
+}
+
+int StyleRecord::size() const {
+    return qPopulationCount(presence);
+}
+
+StyleRecord &StyleRecord::operator+=(const StyleRecord &other) {
+    other.forEach([this](Key key, const QString &value) {
+        values[key] = value;
+    });
+    presence |= other.presence;
+    return *this;
+}
+
+bool StyleRecord::operator==(const StyleRecord &other) const {
+    // Absent values are empty on both sides
+    return presence == other.presence && values == other.values;
+}
+
+QDataStream &operator<<(QDataStream &out, const StyleRecord &record) {
+    out << record.presence;
+    record.forEach([&](StyleRecord::Key, const QString &value) {
+        out << value;
+    });
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, StyleRecord &record) {
+    quint16 presence;
+    in >> presence;
+    record.clear();
+    for (int key = 0; key < StyleRecord::numKeys; ++key)
+        if (presence & (1u << key)) {
+            QString value;
+            in >> value;
+            record.insert(StyleRecord::Key(key), value);
+        }
+    return in;
+}
+
+size_t qHash(const StyleRecord &record, size_t seed) {
+    size_t hash = qHash(record.mask(), seed);
+    record.forEach([&](StyleRecord::Key key, const QString &value) {
+        hash ^= qHash(value, seed + key);
+    });
+    return hash;
+}
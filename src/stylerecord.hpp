@@ -0,0 +1,85 @@
+#ifndef STYLERECORD_HPP
+#define STYLERECORD_HPP
+
+#include <QDataStream>
+#include <QString>
+#include <QtAlgorithms>
+#include <array>
+#include <optional>
+
+/// @brief The styles of a standard button.
+/// @details Keys are limited to #C::C::B::K::basicStyles, so the values are
+/// kept in a fixed array indexed by #Key, along with a bitmask telling which
+/// keys are present. Iteration follows the order of #Key.
+class StyleRecord {
+public:
+    /// @brief Style keys, in the same order as #C::C::B::K::basicStyles
+    enum Key : quint8 {
+        stroke,
+        strokeOpacity,
+        strokeWidth,
+        strokeDashArray,
+        strokeDashOffset,
+        strokeLineCap,
+        strokeLineJoin,
+        strokeMiterLimit,
+        markerStart,
+        markerMid,
+        markerEnd,
+        fill,
+        fillOpacity,
+        fontFamily,
+        fontSize,
+        fontStyle,
+    };
+    static constexpr int numKeys = fontStyle + 1;
+
+    /// @brief Style name of the key, e.g. "stroke-width"
+    static const char *name(Key key);
+    /// @brief The key of a style name, if it's one of the basic styles
+    static std::optional<Key> keyOf(const QString &name);
+
+    bool contains(Key key) const {
+        return presence & (1u << key);
+    }
+    /// @return The value of the key, or an empty string if absent
+    const QString &operator[](Key key) const {
+        return values[key];
+    }
+    void insert(Key key, const QString &value);
+    void remove(Key key);
+    void clear();
+
+    bool isEmpty() const {
+        return !presence;
+    }
+    int size() const;
+    /// @brief Bit `1 << key` is set for each present key
+    quint16 mask() const {
+        return presence;
+    }
+
+    /// @brief Call `func(key, value)` for each present key, in order of #Key
+    template <typename Func> void forEach(Func func) const {
+        for (quint16 rest = presence; rest; rest &= rest - 1) {
+            Key key = Key(qCountTrailingZeroBits(rest));
+            func(key, values[key]);
+        }
+    }
+
+    /// @brief Overwrite with the styles present in other
+    StyleRecord &operator+=(const StyleRecord &other);
+    bool operator==(const StyleRecord &other) const;
+
+    friend QDataStream &operator<<(QDataStream &out, const StyleRecord &record);
+    friend QDataStream &operator>>(QDataStream &in, StyleRecord &record);
+
+private:
+    quint16 presence = 0;
+    /// @brief Values of absent keys are kept empty
+    std::array<QString, numKeys> values;
+};
+
+size_t qHash(const StyleRecord &record, size_t seed = 0);
+
+#endif // STYLERECORD_HPP
@@ -0,0 +1,101 @@
+#include "svgdefgraph.hpp"
+
+#include "svgrefscanner.hpp"
+
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <utility>
+
+SvgDefGraph::SvgDefGraph(const QHash<QString, QString> &svgDefs) {
+    QStringList ids = svgDefs.keys();
+    ids.sort();
+    defs.resize(ids.size());
+    for (int i = 0; i < ids.size(); ++i)
+        indices.insert(ids[i], i);
+
+    // Replace non-displayable attributes so that markers can be displayed.
+    static const QRegularExpression ctxRegEx(
+        R"(\b(context-stroke|context-fill)\b)");
+
+    for (int i = 0; i < ids.size(); ++i) {
+        Def &def = defs[i];
+        def.svg = svgDefs.value(ids[i]);
+        def.displaySvg = QString(def.svg).replace(ctxRegEx, "#fff");
+
+        // Parse direct references
+        SvgRefScanner refs(def.svg);
+        for (QStringView id = refs.next(); !id.isEmpty(); id = refs.next()) {
+            int ref = indices.value(id.toString(), -1);
+            if (ref >= 0 && ref != i && !def.references.contains(ref))
+                def.references.append(ref);
+        }
+    }
+
+    // Rank all defs in post-order, visiting each def once. Reference cycles
+    // are cut where they are met. The stack is explicit, as reference chains
+    // can be arbitrarily deep.
+    ranks.fill(-1, defs.size());
+    int nextRank = 0;
+    QVector<std::pair<int, int>> stack; // {def, next reference to visit}
+    for (int i = 0; i < defs.size(); ++i) {
+        if (ranks[i] >= 0)
+            continue;
+        ranks[i] = -2; // Being visited
+        stack.append({i, 0});
+        while (!stack.isEmpty()) {
+            auto &[cur, next] = stack.last();
+            if (next < defs[cur].references.size()) {
+                int ref = defs[cur].references[next++];
+                if (ranks[ref] == -1) {
+                    ranks[ref] = -2;
+                    stack.append({ref, 0});
+                }
+            } else {
+                ranks[cur] = nextRank++;
+                stack.removeLast();
+            }
+        }
+    }
+}
+
+QVector<int> SvgDefGraph::genClosure(const QVector<int> &roots) const {
+    QVector<int> closure;
+    QSet<int> reached;
+    for (int root : roots)
+        if (!reached.contains(root)) {
+            reached.insert(root);
+            closure.append(root);
+        }
+    // closure doubles as the queue of defs whose references are not visited
+    for (int i = 0; i < closure.size(); ++i)
+        for (int ref : defs[closure[i]].references)
+            if (!reached.contains(ref)) {
+                reached.insert(ref);
+                closure.append(ref);
+            }
+
+    std::sort(closure.begin(), closure.end(), [this](int a, int b) {
+        return ranks[a] < ranks[b];
+    });
+    return closure;
+}
+
+QString SvgDefGraph::genDefsSvg(const QSet<QString> &ids, bool display) const {
+    QVector<int> roots;
+    for (const QString &id : ids)
+        if (int index = indices.value(id, -1); index >= 0)
+            roots.append(index);
+    if (roots.isEmpty())
+        return {};
+
+    QVector<int> closure = genClosure(roots);
+    int length = 0;
+    for (int dep : closure)
+        length += display ? defs[dep].displaySvg.size() : defs[dep].svg.size();
+    QString result;
+    result.reserve(length);
+    for (int dep : closure)
+        result += display ? defs[dep].displaySvg : defs[dep].svg;
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef SVGDEFGRAPH_HPP
+#define SVGDEFGRAPH_HPP
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+/// @brief Svg defs with their references resolved ahead of time.
+/// @details Defs may reference each other through `url(#id)` or
+/// `xlink:href`. The references are parsed once on construction, and all
+/// defs are ranked in one topological order (dependencies first). Composing
+/// the defs of a button walks the references from the defs it uses, then
+/// concatenates the defs reached in rank order, each once. So construction is
+/// linear in the size of the graph, even for deep chains of references.
+class SvgDefGraph {
+public:
+    SvgDefGraph() = default;
+    /// @param svgDefs A map that map the id of defs to their bodies
+    explicit SvgDefGraph(const QHash<QString, QString> &svgDefs);
+
+    /// @brief Generate the defs svg to be used in `<defs></defs>` block
+    /// @param ids Ids of the defs used directly. Unknown ids are ignored.
+    /// @param display Whether to generate the variant for displaying, in
+    /// which `context-stroke` and `context-fill` are replaced by `#fff`, as
+    /// the renderer cannot resolve them.
+    QString genDefsSvg(const QSet<QString> &ids, bool display = false) const;
+
+private:
+    struct Def {
+        QString svg;
+        /// @brief #svg with non-displayable attributes replaced
+        QString displaySvg;
+        /// @brief Indices of the defs this def references directly
+        QVector<int> references;
+    };
+
+    /// @brief Indices of some defs and all defs they depend on, in #ranks
+    /// order
+    QVector<int> genClosure(const QVector<int> &roots) const;
+
+    /// @brief Defs sorted by id, so that the output is deterministic
+    QVector<Def> defs;
+    /// @brief Position of each def of #defs in the topological order
+    QVector<int> ranks;
+    /// @brief Maps ids to indices of #defs
+    QHash<QString, int> indices;
+};
+
+#endif // SVGDEFGRAPH_HPP
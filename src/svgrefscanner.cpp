@@ -0,0 +1,58 @@
+#include "svgrefscanner.hpp"
+
+SvgRefScanner::SvgRefScanner(const QString &text) : text(text) {}
+
+bool SvgRefScanner::endsWithWord(qsizetype end, QLatin1String word) const {
+    qsizetype begin = end - word.size();
+    if (begin < 0 || text.midRef(begin, word.size()) != word)
+        return false;
+    return begin == 0 || !(text[begin - 1].isLetterOrNumber()
+                           || text[begin - 1] == QLatin1Char('_'));
+}
+
+QStringView SvgRefScanner::next() {
+    const QChar *data = text.constData();
+    while ((pos = text.indexOf(QLatin1Char('#'), pos)) >= 0) {
+        qsizetype hash = pos++;
+
+        qsizetype before = hash;
+        QChar quote;
+        if (before > 0
+            && (data[before - 1] == QLatin1Char('\'')
+                || data[before - 1] == QLatin1Char('"')))
+            quote = data[--before];
+
+        // Find where the id ends
+        qsizetype end = -1;
+        if (endsWithWord(before, QLatin1String("url("))) {
+            if (quote.isNull()) {
+                end = text.indexOf(QLatin1Char(')'), pos);
+            } else {
+                // Quotes may appear in the id, look for the closing `')`
+                end = text.indexOf(quote, pos);
+                while (end >= 0 && end + 1 < text.size()
+                       && data[end + 1] != QLatin1Char(')'))
+                    end = text.indexOf(quote, end + 1);
+                if (end + 1 >= text.size())
+                    end = -1;
+            }
+        } else if (!quote.isNull()) {
+            // An attribute, which may have spaces around `=`
+            while (before > 0 && data[before - 1].isSpace())
+                --before;
+            if (before == 0 || data[--before] != QLatin1Char('='))
+                continue;
+            while (before > 0 && data[before - 1].isSpace())
+                --before;
+            if (endsWithWord(before, QLatin1String("href")))
+                end = text.indexOf(quote, pos);
+        }
+
+        if (end > pos) {
+            pos = end;
+            return QStringView(data + hash + 1, end - hash - 1);
+        }
+    }
+    pos = text.size();
+    return {};
+}
@@ -0,0 +1,37 @@
+#ifndef SVGREFSCANNER_HPP
+#define SVGREFSCANNER_HPP
+
+#include <QString>
+#include <QStringView>
+
+/// @brief Finds references to svg defs in svg code or style values.
+/// @details Recognizes `url(#id)`, `url('#id')`, `url("#id")`, and
+/// `href="#id"` / `xlink:href="#id"` attributes. The text is scanned once
+/// from left to right without allocating: every `#` is located with Qt's
+/// vectorized character search, then the few characters around it are checked
+/// against the reference forms. Ids are returned as views into the text.
+/// @code
+/// SvgRefScanner refs(svg);
+/// for (QStringView id = refs.next(); !id.isEmpty(); id = refs.next())
+///     ...
+/// @endcode
+class SvgRefScanner {
+public:
+    /// @param text The text to scan, which must outlive this scanner
+    explicit SvgRefScanner(const QString &text);
+
+    /// @brief Find the next reference
+    /// @return The referenced id, or an empty view if there are no more
+    QStringView next();
+
+private:
+    /// @brief Tell whether the text before #pos ends with @p word, which is
+    /// not preceded by a letter or digit
+    bool endsWithWord(qsizetype pos, QLatin1String word) const;
+
+    const QString &text;
+    /// @brief Where to continue scanning
+    qsizetype pos = 0;
+};
+
+#endif // SVGREFSCANNER_HPP
@@ -0,0 +1,128 @@
+#include "svgwriter.hpp"
+
+#include <charconv>
+
+SvgWriter::SvgWriter(qsizetype reserve) {
+    data.reserve(int(reserve));
+}
+
+SvgWriter &SvgWriter::open(const char *tag) {
+    endStartTag();
+    data += '<';
+    data += tag;
+    tags.append(tag);
+    inStartTag = true;
+    return *this;
+}
+
+SvgWriter &SvgWriter::close() {
+    Q_ASSERT(!tags.isEmpty());
+    if (inStartTag) {
+        data += "/>";
+        inStartTag = false;
+    } else {
+        data += "</";
+        data += tags.last();
+        data += '>';
+    }
+    tags.removeLast();
+    return *this;
+}
+
+SvgWriter &SvgWriter::attr(const char *name, const char *value) {
+    beginAttr(name) << value;
+    return endAttr();
+}
+
+SvgWriter &SvgWriter::attr(const char *name, const QString &value) {
+    beginAttr(name) << value;
+    return endAttr();
+}
+
+SvgWriter &SvgWriter::attr(const char *name, qreal value) {
+    beginAttr(name) << value;
+    return endAttr();
+}
+
+SvgWriter &SvgWriter::beginAttr(const char *name) {
+    Q_ASSERT(inStartTag);
+    data += ' ';
+    data += name;
+    data += "=\"";
+    hasProps = false;
+    return *this;
+}
+
+SvgWriter &SvgWriter::endAttr() {
+    data += '"';
+    return *this;
+}
+
+SvgWriter &SvgWriter::content(const char *text) {
+    endStartTag();
+    return *this << text;
+}
+
+SvgWriter &SvgWriter::content(const QString &text) {
+    endStartTag();
+    return *this << text;
+}
+
+SvgWriter &SvgWriter::content(const QByteArray &text) {
+    endStartTag();
+    return *this << text;
+}
+
+SvgWriter &SvgWriter::operator<<(char c) {
+    data += c;
+    return *this;
+}
+
+SvgWriter &SvgWriter::operator<<(const char *text) {
+    data += text;
+    return *this;
+}
+
+SvgWriter &SvgWriter::operator<<(const QByteArray &text) {
+    data += text;
+    return *this;
+}
+
+SvgWriter &SvgWriter::operator<<(const QString &text) {
+    data += text.toUtf8();
+    return *this;
+}
+
+SvgWriter &SvgWriter::operator<<(int value) {
+    char buffer[16];
+    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    data.append(buffer, int(end - buffer));
+    return *this;
+}
+
+SvgWriter &SvgWriter::operator<<(qreal value) {
+    // Same as QString::arg(double), i.e. "%g"
+    char buffer[32];
+    auto [end, error] = std::to_chars(
+        buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    data.append(buffer, int(end - buffer));
+    return *this;
+}
+
+SvgWriter &SvgWriter::operator<<(const QPointF &point) {
+    return *this << point.x() << ' ' << point.y();
+}
+
+QByteArray SvgWriter::take() {
+    Q_ASSERT(tags.isEmpty());
+    QByteArray result;
+    result.swap(data);
+    return result;
+}
+
+void SvgWriter::endStartTag() {
+    if (inStartTag) {
+        data += '>';
+        inStartTag = false;
+    }
+}
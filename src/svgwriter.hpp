@@ -0,0 +1,85 @@
+#ifndef SVGWRITER_HPP
+#define SVGWRITER_HPP
+
+#include <QByteArray>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/// @brief Writes svg markup straight into one UTF-8 buffer.
+/// @details Elements are opened with open(), given attributes, and closed with
+/// close(), which writes `/>` unless the element got any content. Attribute
+/// values can also be streamed piece by piece between beginAttr() and
+/// endAttr(), such as path data, or style properties with prop(). Numbers are
+/// formatted the way QString::arg(double) does. Nothing is escaped.
+///
+/// ```
+/// SvgWriter svg;
+/// svg.open("path").beginAttr("d") << "M " << from << " H " << to.x();
+/// svg.endAttr().beginAttr("style").prop("fill", "#fff").endAttr().close();
+/// QByteArray data = svg.take();
+/// ```
+class SvgWriter {
+public:
+    /// @param reserve Bytes to allocate up front
+    explicit SvgWriter(qsizetype reserve = 2048);
+
+    /// @brief Start an element, as a child of the current one if any
+    /// @param tag Must outlive the element
+    SvgWriter &open(const char *tag);
+    /// @brief End the current element
+    SvgWriter &close();
+
+    SvgWriter &attr(const char *name, const char *value);
+    SvgWriter &attr(const char *name, const QString &value);
+    SvgWriter &attr(const char *name, qreal value);
+
+    /// @brief Start an attribute whose value is streamed with operator<<()
+    /// or prop()
+    SvgWriter &beginAttr(const char *name);
+    SvgWriter &endAttr();
+
+    /// @brief Append a `name:value` pair to a style attribute
+    template <typename T> SvgWriter &prop(const char *name, const T &value) {
+        if (hasProps)
+            data += ';';
+        hasProps = true;
+        return *this << name << ':' << value;
+    }
+
+    /// @brief Append content to the current element
+    SvgWriter &content(const char *text);
+    SvgWriter &content(const QString &text);
+    SvgWriter &content(const QByteArray &text);
+
+    /// @{
+    /// @brief Append raw text, e.g. part of an attribute value
+    SvgWriter &operator<<(char c);
+    SvgWriter &operator<<(const char *text);
+    SvgWriter &operator<<(const QByteArray &text);
+    SvgWriter &operator<<(const QString &text);
+    SvgWriter &operator<<(int value);
+    SvgWriter &operator<<(qreal value);
+    /// @brief Append the coordinates of a point, separated by a space
+    SvgWriter &operator<<(const QPointF &point);
+    /// @}
+
+    /// @brief Take the written svg, leaving the writer empty
+    /// @pre All elements are closed
+    QByteArray take();
+
+private:
+    /// @brief Finish the start tag of the current element, if it's open
+    void endStartTag();
+
+    QByteArray data;
+    /// @brief Tags of the elements not closed yet
+    QVector<const char *> tags;
+    /// @brief Whether the start tag of the current element is still open,
+    /// i.e. it can take attributes
+    bool inStartTag = false;
+    /// @brief Whether the current attribute got any prop()
+    bool hasProps = false;
+};
+
+#endif // SVGWRITER_HPP
@@ -0,0 +1,200 @@
+/// @file
+/// @brief Checks that IndicatorPainter draws what resvg renders.
+/// @details Each case is a standard style IndicatorPainter covers. It's drawn
+/// by IndicatorPainter, and its svg from genIndicatorsSvg() is rendered by
+/// resvg, for both icon styles, both orientations and two device pixel
+/// ratios. A pixel matches if no channel differs by more than the tolerance.
+/// Only pixels inked in either image count, so that an indicator missing from
+/// one of them fails however small it is. Rasterizers anti-alias edges a bit
+/// differently, so a small share of mismatching pixels is allowed. The total
+/// ink, i.e. coverage, of both images must also be close. Prints one line per
+/// failure, and returns 1 if any.
+
+#include "buttoninfo.hpp"
+#include "configs.hpp"
+#include "constants.hpp"
+#include "indicatorpainter.hpp"
+#include "indicatorsvg.hpp"
+#include "stylerecord.hpp"
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include <ResvgQt.h>
+#include <cstdlib>
+#include <utility>
+
+using CBK = StyleRecord;
+
+/// @brief A style to draw, and how close both renderings must be
+struct Case {
+    const char *name;
+    QVector<std::pair<CBK::Key, const char *>> styles;
+    /// @brief Largest difference of a channel for a pixel to match
+    int tolerance;
+    /// @brief Share of the inked pixels allowed not to match
+    qreal maxMismatch;
+};
+
+/// @brief Shapes only differ along their edges. Text is shaped by different
+/// engines, and glyphs are mostly edges, so they are allowed to differ more.
+static const Case cases[] = {
+    {"fill", {{CBK::fill, "#ff0000"}}, 48, .05},
+    {"stroke", {{CBK::stroke, "#00ff00"}}, 48, .05},
+    {"fill-stroke",
+     {{CBK::fill, "#123456"}, {CBK::stroke, "#abcdef"}},
+     48,
+     .05},
+    {"dasharray", {{CBK::strokeDashArray, "4 2"}}, 48, .05},
+    {"dashoffset",
+     {{CBK::stroke, "#fff"},
+      {CBK::strokeDashArray, "3,1"},
+      {CBK::strokeDashOffset, "2"}},
+     48,
+     .05},
+    {"fill-opacity",
+     {{CBK::fill, "#0000ff"}, {CBK::fillOpacity, "0.5"}},
+     48,
+     .05},
+    {"stroke-opacity",
+     {{CBK::stroke, "#ffff00"}, {CBK::strokeOpacity, "0.3"}},
+     48,
+     .05},
+    {"stroke-width", {{CBK::strokeWidth, "4"}}, 48, .05},
+    {"linecap-butt", {{CBK::strokeLineCap, "butt"}}, 48, .05},
+    {"linecap-round", {{CBK::strokeLineCap, "round"}}, 48, .05},
+    {"linecap-square", {{CBK::strokeLineCap, "square"}}, 48, .05},
+    {"linejoin-miter", {{CBK::strokeLineJoin, "miter"}}, 48, .05},
+    {"linejoin-round", {{CBK::strokeLineJoin, "round"}}, 48, .05},
+    {"linejoin-bevel", {{CBK::strokeLineJoin, "bevel"}}, 48, .05},
+    {"font-family", {{CBK::fontFamily, "serif"}}, 96, .25},
+    {"font-style", {{CBK::fontStyle, "italic"}}, 96, .25},
+    {"font-size", {{CBK::fontSize, "12px"}}, 96, .25},
+    {"unknown", {}, 96, .25},
+};
+
+/// @return Share of the pixels inked in @p a or @p b that differ beyond
+/// @p tolerance, or 1 if neither image has any ink
+static qreal _genMismatch(const QImage &a, const QImage &b, int tolerance) {
+    QImage x = a.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage y = b.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    qint64 inked = 0, mismatches = 0;
+    for (int row = 0; row < x.height(); ++row) {
+        auto p = reinterpret_cast<const QRgb *>(x.constScanLine(row));
+        auto q = reinterpret_cast<const QRgb *>(y.constScanLine(row));
+        for (int col = 0; col < x.width(); ++col) {
+            if (!qAlpha(p[col]) && !qAlpha(q[col]))
+                continue;
+            ++inked;
+            if (std::abs(qRed(p[col]) - qRed(q[col])) > tolerance
+                || std::abs(qGreen(p[col]) - qGreen(q[col])) > tolerance
+                || std::abs(qBlue(p[col]) - qBlue(q[col])) > tolerance
+                || std::abs(qAlpha(p[col]) - qAlpha(q[col])) > tolerance)
+                ++mismatches;
+        }
+    }
+    return inked ? qreal(mismatches) / qreal(inked) : 1.;
+}
+
+/// @return Coverage of an image, in pixels
+static qreal _genInk(const QImage &image) {
+    QImage x = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    qint64 alpha = 0;
+    for (int row = 0; row < x.height(); ++row) {
+        auto p = reinterpret_cast<const QRgb *>(x.constScanLine(row));
+        for (int col = 0; col < x.width(); ++col)
+            alpha += qAlpha(p[col]);
+    }
+    return qreal(alpha) / 255.;
+}
+
+/// @brief How much the ink of both renderings may differ, relative to the
+/// larger one
+constexpr qreal maxInkDifference = .2;
+
+int main(int argc, char *argv[]) {
+    // No display needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QTemporaryDir dir;
+    Configs configs(dir.filePath("config.yaml"), dir.filePath("gen.yaml"));
+    ResvgOptions options;
+    options.loadSystemFonts();
+
+    // About the size of a hovered style button icon, in user units
+    const QSizeF iconSize(100, 87);
+
+    int numFailed = 0, numChecked = 0;
+    for (const char *iconStyle :
+         {C::C::G::V::DIS::circle, C::C::G::V::DIS::square}) {
+        configs.defaultIconStyle = iconStyle;
+        for (bool orientation : {true, false}) {
+            // The centroid is a third of the height away from the base
+            QPointF centroid(
+                iconSize.width() / 2,
+                iconSize.height() * (orientation ? 2. / 3. : 1. / 3.));
+            IndicatorAnchors anchors = genStyleButtonAnchors(
+                iconSize, centroid, configs, orientation);
+
+            for (const Case &test : cases) {
+                StyleRecord styles;
+                for (const auto &[key, value] : test.styles)
+                    styles.insert(key, value);
+                StandardButtonInfo info({}, styles, {});
+                info.bindDefs(configs.getSvgDefGraph());
+                QByteArray svg = genIndicatorsSvg(anchors, configs, info);
+
+                for (qreal dpr : {1., 2.}) {
+                    QSize size = (iconSize * dpr).toSize();
+                    QString label = QString("%1 %2 %3 @%4x")
+                                        .arg(test.name, iconStyle)
+                                        .arg(orientation ? "up" : "down")
+                                        .arg(dpr);
+                    ++numChecked;
+
+                    QImage painted =
+                        IndicatorPainter::paint(anchors, size, configs, info);
+                    if (painted.isNull()) {
+                        out << "FAIL " << label << ": not painted\n";
+                        ++numFailed;
+                        continue;
+                    }
+                    ResvgRenderer renderer(svg, options);
+                    QImage rendered = renderer.renderToImage(size);
+                    if (rendered.size() != size) {
+                        out << "FAIL " << label << ": resvg failed\n";
+                        ++numFailed;
+                        continue;
+                    }
+
+                    qreal paintedInk = _genInk(painted);
+                    qreal renderedInk = _genInk(rendered);
+                    qreal mismatch =
+                        _genMismatch(painted, rendered, test.tolerance);
+                    if (qAbs(paintedInk - renderedInk)
+                        > maxInkDifference * qMax(paintedInk, renderedInk)) {
+                        out << "FAIL " << label << ": ink of "
+                            << QString::number(paintedInk, 'f', 1)
+                            << " px painted, "
+                            << QString::number(renderedInk, 'f', 1)
+                            << " px rendered\n";
+                        ++numFailed;
+                    } else if (mismatch > test.maxMismatch) {
+                        out << "FAIL " << label << ": "
+                            << QString::number(mismatch * 100, 'f', 2)
+                            << "% of inked pixels differ\n";
+                        ++numFailed;
+                    }
+                }
+            }
+        }
+    }
+
+    out << numChecked - numFailed << " of " << numChecked << " passed\n";
+    return numFailed ? 1 : 0;
+}
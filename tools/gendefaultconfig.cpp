@@ -0,0 +1,378 @@
+/// @file
+/// @brief Compile res/default.yaml into C++ tables.
+/// @details Usage: `gendefaultconfig <default.yaml> <output.hpp>`. The output
+/// defines the tables declared in src/defaultconfig.hpp. Unlike user configs,
+/// which are checked leniently at runtime, any problem in the default config
+/// fails the build.
+
+#include "constants.hpp"
+#include "svgrefscanner.hpp"
+
+#include <QByteArray>
+#include <QColor>
+#include <QCryptographicHash>
+#include <QString>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace {
+
+/// @brief Thrown on any error in the default config
+struct ConfigError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+/// @brief Quote a UTF-8 string as a C++ string literal
+std::string quote(const std::string &str) {
+    std::string result = "\"";
+    for (unsigned char c : str) {
+        switch (c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (c < 0x20 || c >= 0x7f) {
+                // Octal escapes never swallow the following characters
+                char escaped[5];
+                std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+                result += escaped;
+            } else {
+                result += char(c);
+            }
+        }
+    }
+    return result + "\"";
+}
+
+std::string quoteOrNull(const YAML::Node &node) {
+    return node.IsDefined() ? quote(node.as<std::string>()) : "nullptr";
+}
+
+/// @brief Global entries and the identifiers they're generated as
+enum class GlobalType {
+    String,
+    Color,
+    IconStyle,
+    Bool,
+    UInt8,
+    UInt32,
+    StringList
+};
+struct GlobalEntry {
+    const char *key;
+    const char *identifier;
+    GlobalType type;
+};
+
+const GlobalEntry globalEntries[] = {
+    {C::C::G::K::shortcutMainPanel, "shortcutMainPanel", GlobalType::String},
+    {C::C::G::K::shortcutTex, "shortcutTex", GlobalType::String},
+    {C::C::G::K::shortcutCompiledTex, "shortcutCompiledTex",
+     GlobalType::String},
+    {C::C::G::K::buttonBgColorInactive, "buttonBgColorInactive",
+     GlobalType::Color},
+    {C::C::G::K::buttonBgColorActive, "buttonBgColorActive",
+     GlobalType::Color},
+    {C::C::G::K::guideColor, "guideColor", GlobalType::Color},
+    {C::C::G::K::panelMaxLevels, "panelMaxLevels", GlobalType::UInt8},
+    {C::C::G::K::panelRadius, "panelRadius", GlobalType::UInt32},
+    {C::C::G::K::defaultIconStyle, "defaultIconStyle", GlobalType::IconStyle},
+    {C::C::G::K::defaultIconText, "defaultIconText", GlobalType::String},
+    {C::C::G::K::texCompileTemplate, "texCompileTemplate", GlobalType::String},
+    {C::C::G::K::texEditorCmd, "texEditorCmd", GlobalType::StringList},
+    {C::C::G::K::texCompileCmd, "texCompileCmd", GlobalType::StringList},
+    {C::C::G::K::pdfToSvgCmd, "pdfToSvgCmd", GlobalType::StringList},
+    {C::C::G::K::watchConfig, "watchConfig", GlobalType::Bool},
+    {C::C::G::K::warmUpThreads, "warmUpThreads", GlobalType::UInt32},
+    {C::C::G::K::warmUpBudgetMs, "warmUpBudgetMs", GlobalType::UInt32},
+    {C::C::G::K::iconCacheMb, "iconCacheMb", GlobalType::UInt32},
+};
+
+/// @brief Generate the `Global` namespace
+/// @return The panel-max-levels setting, for checking slots
+unsigned genGlobal(const YAML::Node &config, std::ostream &out) {
+    namespace CC = C::C;
+    namespace DIS = C::C::G::V::DIS;
+
+    const YAML::Node &global = config[CC::global];
+    if (!global.IsMap())
+        throw ConfigError(std::string(CC::global) + " is not a map");
+
+    // The default config must set everything, since there's nothing below it
+    std::set<std::string> knownKeys;
+    for (const GlobalEntry &entry : globalEntries)
+        knownKeys.insert(entry.key);
+    for (const auto &elem : global)
+        if (!knownKeys.count(elem.first.Scalar()))
+            throw ConfigError(
+                "unknown key " + std::string(CC::global) + ":"
+                + elem.first.Scalar());
+
+    unsigned panelMaxLevels = 0;
+    out << "namespace Global {\n";
+    for (const GlobalEntry &entry : globalEntries) {
+        const YAML::Node &node = global[entry.key];
+        std::string path = std::string(CC::global) + ":" + entry.key;
+        if (!node.IsDefined())
+            throw ConfigError(path + " is missing");
+
+        if (entry.type == GlobalType::StringList) {
+            if (!node.IsSequence())
+                throw ConfigError(path + " is not a list");
+            out << "inline constexpr std::array<const char *, " << node.size()
+                << "> " << entry.identifier << "{";
+            for (const YAML::Node &elem : node) {
+                if (!elem.IsScalar())
+                    throw ConfigError(path + " contains a non-string");
+                out << "\n    " << quote(elem.Scalar()) << ",";
+            }
+            out << "};\n";
+            continue;
+        }
+
+        if (!node.IsScalar())
+            throw ConfigError(path + " is not a scalar");
+        const std::string &value = node.Scalar();
+        switch (entry.type) {
+        case GlobalType::Color:
+            if (!QColor::isValidColor(QString::fromStdString(value)))
+                throw ConfigError(path + " is not a valid color");
+            [[fallthrough]];
+        case GlobalType::String:
+            out << "inline constexpr const char *" << entry.identifier << " = "
+                << quote(value) << ";\n";
+            break;
+        case GlobalType::IconStyle:
+            if (value != DIS::circle && value != DIS::square)
+                throw ConfigError(path + " = " + value + " not recognized");
+            out << "inline constexpr const char *" << entry.identifier << " = "
+                << quote(value) << ";\n";
+            break;
+        case GlobalType::Bool:
+            out << "inline constexpr bool " << entry.identifier << " = "
+                << (node.as<bool>() ? "true" : "false") << ";\n";
+            break;
+        case GlobalType::UInt8:
+            panelMaxLevels = node.as<unsigned>();
+            if (panelMaxLevels < 1 || panelMaxLevels > 0xff)
+                throw ConfigError(path + " out of range");
+            out << "inline constexpr quint8 " << entry.identifier << " = "
+                << panelMaxLevels << ";\n";
+            break;
+        case GlobalType::UInt32:
+            out << "inline constexpr quint32 " << entry.identifier << " = "
+                << node.as<quint32>() << ";\n";
+            break;
+        case GlobalType::StringList:
+            break;
+        }
+    }
+    out << "} // namespace Global\n\n";
+    return panelMaxLevels;
+}
+
+/// @brief Generate the #svgDefs table
+/// @return Ids of all defined defs
+std::set<std::string> genSvgDefs(const YAML::Node &config, std::ostream &out) {
+    namespace CC = C::C;
+    namespace K = C::C::SD::K;
+
+    std::set<std::string> ids;
+    const YAML::Node &defs = config[CC::svgDefs];
+    if (!defs.IsDefined()) {
+        out << "inline constexpr std::array<SvgDef, 0> svgDefs{};\n\n";
+        return ids;
+    }
+    if (!defs.IsSequence())
+        throw ConfigError(std::string(CC::svgDefs) + " is not a list");
+
+    std::ostringstream entries;
+    size_t numDefs = 0;
+    for (const YAML::Node &def : defs) {
+        std::string path =
+            std::string(CC::svgDefs) + "[" + std::to_string(++numDefs) + "]";
+        if (!def.IsMap())
+            throw ConfigError(path + " is not a map");
+        for (const char *key : {K::id, K::type})
+            if (!def[key].IsDefined())
+                throw ConfigError(path + " missing " + key);
+        if (def[K::attrs].IsDefined() && !def[K::attrs].IsMap())
+            throw ConfigError(path + ":" + K::attrs + " is not a map");
+
+        std::string id = def[K::id].as<std::string>();
+        if (!ids.insert(id).second)
+            throw ConfigError(path + ": id " + id + " already registered");
+
+        // Compose the def the same way as Config::parseSvgDefsConfig
+        std::string type = def[K::type].as<std::string>();
+        std::string attrs;
+        if (def[K::attrs].IsDefined())
+            for (const auto &attr : def[K::attrs])
+                attrs += (attrs.empty() ? "" : " ") + attr.first.Scalar()
+                         + "=\"" + attr.second.as<std::string>() + "\"";
+        std::string content =
+            def[K::svg].IsDefined() ? def[K::svg].as<std::string>() : "";
+        std::string svg = "<" + type + " id=\"" + id + "\" " + attrs + ">"
+                          + content + "</" + type + ">";
+
+        entries << "    {" << quote(id) << ",\n     " << quote(svg) << "},\n";
+    }
+    out << "inline constexpr std::array<SvgDef, " << numDefs << "> svgDefs{{\n"
+        << entries.str() << "}};\n\n";
+    return ids;
+}
+
+/// @brief Generate the #styles, #defIds and #buttons tables
+void genButtons(
+    const YAML::Node &config, unsigned panelMaxLevels,
+    const std::set<std::string> &svgDefIds, std::ostream &out) {
+    namespace CC = C::C;
+    namespace BK = C::C::B::K;
+
+    std::vector<std::string> styles, defIds, buttons;
+    const YAML::Node &buttonsNode = config[CC::buttons];
+    if (buttonsNode.IsDefined() && !buttonsNode.IsSequence())
+        throw ConfigError(std::string(CC::buttons) + " is not a list");
+
+    std::set<std::string> validKeys({BK::slot, BK::customIcon, BK::customStyle});
+    for (const char *key : BK::basicStyles)
+        validKeys.insert(key);
+
+    std::set<quint32> slots;
+    size_t numButtons = 0;
+    for (const YAML::Node &button : buttonsNode) {
+        std::string path =
+            std::string(CC::buttons) + "[" + std::to_string(++numButtons) + "]";
+        if (!button.IsMap())
+            throw ConfigError(path + " is not a map");
+        for (const auto &elem : button)
+            if (!validKeys.count(elem.first.Scalar()))
+                throw ConfigError(path + ": invalid key " + elem.first.Scalar());
+        if (!button[BK::slot].IsDefined())
+            throw ConfigError(path + " missing " + BK::slot);
+
+        quint32 slot = button[BK::slot].as<quint32>();
+        quint8 p = slot >> 24 & 0xff, t = slot >> 16 & 0xff,
+               r = slot >> 8 & 0xff, s = slot & 0xff;
+        if (p > panelMaxLevels * 6 || t > 5 || r > 2 || s > r * 2)
+            throw ConfigError(path + ": invalid slot " + std::to_string(slot));
+        if (!slots.insert(slot).second)
+            throw ConfigError(
+                path + ": slot " + std::to_string(slot) + " already registered");
+
+        // Collect styles, and the defs they use
+        size_t firstStyle = styles.size();
+        std::string styleText;
+        if (button[BK::customStyle].IsDefined()) {
+            styleText = button[BK::customStyle].as<std::string>();
+        } else {
+            for (size_t key = 0; key < std::size(BK::basicStyles); ++key)
+                if (button[BK::basicStyles[key]].IsDefined()) {
+                    std::string value =
+                        button[BK::basicStyles[key]].as<std::string>();
+                    styles.push_back(
+                        "    {" + std::to_string(key) + ", " + quote(value)
+                        + "},\n");
+                    styleText += value + ";";
+                }
+        }
+
+        size_t firstDefId = defIds.size();
+        std::set<std::string> usedIds;
+        // Detect references the same way as the runtime does
+        QString text = QString::fromStdString(styleText);
+        SvgRefScanner refs(text);
+        for (QStringView ref = refs.next(); !ref.isEmpty(); ref = refs.next()) {
+            std::string id = ref.toString().toStdString();
+            if (!svgDefIds.count(id))
+                throw ConfigError(path + " uses undefined def " + id);
+            if (usedIds.insert(id).second)
+                defIds.push_back("    " + quote(id) + ",\n");
+        }
+
+        std::ostringstream entry;
+        entry << "    {" << slot << "u, " << quoteOrNull(button[BK::customIcon])
+              << ",\n     " << quoteOrNull(button[BK::customStyle]) << ", "
+              << firstStyle << ", " << styles.size() - firstStyle << ", "
+              << firstDefId << ", " << defIds.size() - firstDefId << "},\n";
+        buttons.push_back(entry.str());
+    }
+
+    auto genTable = [&](const char *type, const char *name,
+                        const std::vector<std::string> &rows) {
+        out << "inline constexpr std::array<" << type << ", " << rows.size()
+            << "> " << name << "{{\n";
+        for (const std::string &row : rows)
+            out << row;
+        out << "}};\n\n";
+    };
+    genTable("Style", "styles", styles);
+    genTable("const char *", "defIds", defIds);
+    genTable("Button", "buttons", buttons);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) try {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <default.yaml> <output.hpp>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::string source(
+        (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    YAML::Node config = YAML::Load(source);
+
+    std::ostringstream out;
+    out << "// Generated from " << argv[1] << ". Do not edit.\n"
+        << "#ifndef DEFAULTCONFIGDATA_HPP\n"
+        << "#define DEFAULTCONFIGDATA_HPP\n\n"
+        << "#include \"defaultconfig.hpp\"\n\n"
+        << "// clang-format off\n"
+        << "namespace DefaultConfig {\n\n";
+
+    // Identifies the content of the default config, e.g. for cache keys
+    out << "inline constexpr const char *digest = "
+        << quote(QCryptographicHash::hash(
+                     QByteArray::fromStdString(source),
+                     QCryptographicHash::Sha1)
+                     .toHex()
+                     .toStdString())
+        << ";\n\n";
+
+    unsigned panelMaxLevels = genGlobal(config, out);
+    std::set<std::string> svgDefIds = genSvgDefs(config, out);
+    genButtons(config, panelMaxLevels, svgDefIds, out);
+
+    out << "} // namespace DefaultConfig\n"
+        << "// clang-format on\n\n"
+        << "#endif // DEFAULTCONFIGDATA_HPP\n";
+
+    std::ofstream output(argv[2], std::ios::binary);
+    output << out.str();
+    return output ? 0 : 1;
+} catch (std::exception &e) {
+    std::fprintf(stderr, "%s: %s\n", argc > 1 ? argv[1] : "", e.what());
+    return 1;
+}